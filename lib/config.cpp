@@ -21,6 +21,17 @@ Config readConfig(const std::string& filename) {
     cfg.filter.lowcut = filter["lowcut"].as<double>();
     cfg.filter.highcut = filter["highcut"].as<double>();
     cfg.filter.type = filter["type"].as<std::string>();
+    cfg.filter.design = filter["design"].as<std::string>("butterworth");
+    cfg.filter.ripple = filter["ripple"].as<double>(1.0);
+    cfg.filter.attenuation = filter["attenuation"].as<double>(40.0);
+    cfg.filter.window = filter["window"].as<std::string>("hamming");
+    cfg.filter.fir_mode = filter["fir_mode"].as<std::string>("auto");
+    cfg.filter.iir_mode = filter["iir_mode"].as<std::string>("auto");
+    cfg.filter.fixed_point = filter["fixed_point"].as<bool>(false);
+    cfg.filter.fraction_bits = filter["fraction_bits"].as<int>(14);
+    cfg.filter.notch = filter["notch"].as<double>(0.0);
+    cfg.filter.notch_harmonics = filter["notch_harmonics"].as<int>(1);
+    cfg.filter.notch_q = filter["notch_q"].as<double>(30.0);
 
     // Load recording settings
     YAML::Node recording = config["recording"];
@@ -33,10 +44,65 @@ Config readConfig(const std::string& filename) {
     YAML::Node buffer = config["buffer"];
     cfg.buffer.size = buffer["size"].as<int>();
     cfg.buffer.window_size = buffer["window_size"].as<int>();
+    cfg.buffer.chunk_size = buffer["chunk_size"].as<int>(1);
+    cfg.buffer.ring_size = buffer["ring_size"].as<int>(8192);
 
     YAML::Node model = config["model"];
     cfg.model.path = model["path"].as<std::string>();
     cfg.model.input_size = model["input_size"].as<int>();
+    cfg.model.batch_size = model["batch_size"].as<int>(256);
+
+    // Load pipeline settings (optional section)
+    YAML::Node pipeline = config["pipeline"];
+    cfg.pipeline.sample_type = pipeline["sample_type"].as<std::string>("double");
+    cfg.pipeline.threads = pipeline["threads"].as<int>(1);
+    cfg.pipeline.pin_threads = pipeline["pin_threads"].as<bool>(true);
+    cfg.pipeline.source = pipeline["source"].as<std::string>("lsl");
+    cfg.pipeline.replay_loops = pipeline["replay_loops"].as<int>(1);
+
+    // Load re-referencing settings (optional section)
+    YAML::Node reference = config["reference"];
+    cfg.reference.mode = reference["mode"].as<std::string>("none");
+    cfg.reference.block = reference["block"].as<int>(0);
+    cfg.reference.resolution = reference["resolution"].as<double>(1.0);
+
+    // Load noise estimation and detection settings (optional sections)
+    YAML::Node noise = config["noise"];
+    cfg.noise.time_constant = noise["time_constant"].as<double>(2.0);
+    cfg.noise.update_interval = noise["update_interval"].as<int>(1000);
+    YAML::Node detector = config["detector"];
+    cfg.detector.type = detector["type"].as<std::string>("amplitude");
+    cfg.detector.threshold = detector["threshold"].as<double>(5.0);
+    cfg.detector.warmup = detector["warmup"].as<double>(5.0);
+    cfg.detector.align_window = detector["align_window"].as<double>(0.0);
+    cfg.detector.interpolation = detector["interpolation"].as<std::string>("none");
+    cfg.detector.neo_window = detector["neo_window"].as<int>(5);
+    cfg.detector.templates = detector["templates"].as<std::string>("");
+    cfg.detector.events_path = detector["events_path"].as<std::string>("");
+    const double settling_time = NoiseConfig::settling * cfg.noise.time_constant;
+    if (cfg.detector.warmup < settling_time) {
+        std::cout << "detector.warmup " << cfg.detector.warmup << " s is shorter than the noise estimate takes to settle, using "
+                  << settling_time << " s" << std::endl;
+        cfg.detector.warmup = settling_time;
+    }
+
+    // Load pipeline metrics settings (optional section)
+    YAML::Node metrics = config["metrics"];
+    cfg.metrics.interval = metrics["interval"].as<double>(1.0);
+    cfg.metrics.outlet = metrics["outlet"].as<bool>(true);
+    cfg.metrics.path = metrics["path"].as<std::string>("");
+
+    // Load LFP branch settings (optional section)
+    YAML::Node lfp = config["lfp"];
+    cfg.lfp.enabled = lfp["enabled"].as<bool>(false);
+    cfg.lfp.rate = lfp["rate"].as<int>(1000);
+    cfg.lfp.cutoff = lfp["cutoff"].as<double>(300.0);
+    cfg.lfp.taps = lfp["taps"].as<int>(301);
+
+    // Load runtime control settings (optional section)
+    YAML::Node control = config["control"];
+    cfg.control.watch = control["watch"].as<bool>(false);
+    cfg.control.interval = control["interval"].as<double>(0.5);
 
     return cfg;
 }
@@ -57,6 +123,17 @@ void printConfig(const Config& cfg) {
     std::cout << "  lowcut: " << cfg.filter.lowcut << std::endl;
     std::cout << "  highcut: " << cfg.filter.highcut << std::endl;
     std::cout << "  type: " << cfg.filter.type << std::endl;
+    std::cout << "  design: " << cfg.filter.design << std::endl;
+    std::cout << "  ripple: " << cfg.filter.ripple << std::endl;
+    std::cout << "  attenuation: " << cfg.filter.attenuation << std::endl;
+    std::cout << "  window: " << cfg.filter.window << std::endl;
+    std::cout << "  fir_mode: " << cfg.filter.fir_mode << std::endl;
+    std::cout << "  iir_mode: " << cfg.filter.iir_mode << std::endl;
+    std::cout << "  fixed_point: " << (cfg.filter.fixed_point ? "true" : "false") << std::endl;
+    std::cout << "  fraction_bits: " << cfg.filter.fraction_bits << std::endl;
+    std::cout << "  notch: " << cfg.filter.notch << std::endl;
+    std::cout << "  notch_harmonics: " << cfg.filter.notch_harmonics << std::endl;
+    std::cout << "  notch_q: " << cfg.filter.notch_q << std::endl;
 
     std::cout << "Recording Settings:" << std::endl;
     std::cout << "  do_record: " << (cfg.recording.do_record ? "true" : "false") << std::endl;
@@ -67,8 +144,52 @@ void printConfig(const Config& cfg) {
     std::cout << "Buffer Settings:" << std::endl;
     std::cout << "  size: " << cfg.buffer.size << std::endl;
     std::cout << "  window_size: " << cfg.buffer.window_size << std::endl;
+    std::cout << "  chunk_size: " << cfg.buffer.chunk_size << std::endl;
+    std::cout << "  ring_size: " << cfg.buffer.ring_size << std::endl;
 
     std::cout << "Model Settings:" << std::endl;
     std::cout << "  path: " << cfg.model.path << std::endl;
     std::cout << "  input_size: " << cfg.model.input_size << std::endl;
+    std::cout << "  batch_size: " << cfg.model.batch_size << std::endl;
+
+    std::cout << "Pipeline Settings:" << std::endl;
+    std::cout << "  sample_type: " << cfg.pipeline.sample_type << std::endl;
+    std::cout << "  threads: " << cfg.pipeline.threads << std::endl;
+    std::cout << "  pin_threads: " << (cfg.pipeline.pin_threads ? "true" : "false") << std::endl;
+    std::cout << "  source: " << cfg.pipeline.source << std::endl;
+    std::cout << "  replay_loops: " << cfg.pipeline.replay_loops << std::endl;
+
+    std::cout << "Reference Settings:" << std::endl;
+    std::cout << "  mode: " << cfg.reference.mode << std::endl;
+    std::cout << "  block: " << cfg.reference.block << std::endl;
+    std::cout << "  resolution: " << cfg.reference.resolution << std::endl;
+
+    std::cout << "Noise Settings:" << std::endl;
+    std::cout << "  time_constant: " << cfg.noise.time_constant << std::endl;
+    std::cout << "  update_interval: " << cfg.noise.update_interval << std::endl;
+
+    std::cout << "Detector Settings:" << std::endl;
+    std::cout << "  type: " << cfg.detector.type << std::endl;
+    std::cout << "  threshold: " << cfg.detector.threshold << std::endl;
+    std::cout << "  warmup: " << cfg.detector.warmup << std::endl;
+    std::cout << "  align_window: " << cfg.detector.align_window << std::endl;
+    std::cout << "  interpolation: " << cfg.detector.interpolation << std::endl;
+    std::cout << "  neo_window: " << cfg.detector.neo_window << std::endl;
+    std::cout << "  templates: " << cfg.detector.templates << std::endl;
+    std::cout << "  events_path: " << cfg.detector.events_path << std::endl;
+
+    std::cout << "Metrics Settings:" << std::endl;
+    std::cout << "  interval: " << cfg.metrics.interval << std::endl;
+    std::cout << "  outlet: " << (cfg.metrics.outlet ? "true" : "false") << std::endl;
+    std::cout << "  path: " << cfg.metrics.path << std::endl;
+
+    std::cout << "LFP Settings:" << std::endl;
+    std::cout << "  enabled: " << (cfg.lfp.enabled ? "true" : "false") << std::endl;
+    std::cout << "  rate: " << cfg.lfp.rate << std::endl;
+    std::cout << "  cutoff: " << cfg.lfp.cutoff << std::endl;
+    std::cout << "  taps: " << cfg.lfp.taps << std::endl;
+
+    std::cout << "Control Settings:" << std::endl;
+    std::cout << "  watch: " << (cfg.control.watch ? "true" : "false") << std::endl;
+    std::cout << "  interval: " << cfg.control.interval << std::endl;
 }
\ No newline at end of file
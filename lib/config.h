@@ -4,11 +4,24 @@
 #include <string>
 
 struct FilterConfig {
-    std::string filter_class;
+    std::string filter_class;   // "iir", "fir" or "biquad" (one bandpass section at the band centre)
     int order;
     double lowcut;
     double highcut;
     std::string type;
+    std::string design;     // IIR: "butterworth", "chebyshev1" or "chebyshev2"
+    double ripple;          // chebyshev1 passband ripple in dB
+    double attenuation;     // chebyshev2 stopband attenuation in dB
+    std::string window;     // FIR: "hamming", "hann", "blackman" or "boxcar"
+    std::string fir_mode;   // FIR: "auto" (measured at startup), "direct" or "fft"
+    std::string iir_mode;   // IIR: "auto", "channel" (SIMD across channels) or "time" (SIMD along time)
+    bool fixed_point;       // IIR in int16 / int32 fixed-point arithmetic instead of the sample type
+    int fraction_bits;      // fixed point: fraction bits of the denominator coefficients (Q(15 - n).n)
+    double notch;           // line frequency in Hz to reject (50 or 60), 0 for none
+    int notch_harmonics;    // number of notched multiples of the line frequency, the fundamental included
+    double notch_q;         // quality factor of each notch (centre frequency / rejected bandwidth)
+
+    bool operator==(const FilterConfig &) const = default;
 };
 
 struct RecordConfig {
@@ -21,11 +34,65 @@ struct RecordConfig {
 struct BufferConfig {
     int size;
     int window_size;
+    int chunk_size;     // samples pulled from the inlet per block
+    int ring_size;      // samples buffered between the receive and the processing thread, at least 2 chunks
 };
 
 struct ModelConfig {
     std::string path;
     int input_size;
+    int batch_size;     // max spikes per forward pass
+};
+
+struct NoiseConfig {
+    double time_constant;   // seconds of history the robust noise estimate forgets with
+    int update_interval;    // samples between threshold updates
+
+    // time constants the estimate needs to converge from zero, detection stays off until then
+    static constexpr double settling = 2.0;
+};
+
+struct ReferenceConfig {
+    std::string mode;       // "none", "average" (CAR) or "median" (CMR)
+    int block;              // with use_layout: side of the square electrode groups on the layout, 0 = whole layout
+    double resolution;      // median: resolution of the fallback search, in input units (ADC counts)
+};
+
+struct DetectorConfig {
+    std::string type;       // "amplitude", "neo" (smoothed energy operator) or "matched" (per-channel template)
+    double threshold;       // detection threshold in multiples of the noise level (neo: of the mean energy)
+    double warmup;          // seconds without detection while the noise estimate settles, at least settling * time_constant
+    double align_window;    // seconds after the crossing searched for the negative peak, 0 cuts at the crossing
+    std::string interpolation;  // sub-sample peak refinement: "none", "cubic" or "sinc"
+    int neo_window;         // length of the Bartlett window smoothing the energy, odd
+    std::string templates;  // matched filter templates, one row per channel or one for all; empty for a generic spike
+    std::string events_path;    // CSV file of the detected events (sample, channel), empty for none
+};
+
+struct MetricsConfig {
+    double interval;        // seconds of signal between reports, 0 disables them
+    bool outlet;            // publish reports on the <stream_name>_metrics LSL outlet
+    std::string path;       // JSON-lines file for the reports, empty for none
+};
+
+struct LfpConfig {
+    bool enabled;           // publish a decimated low-pass copy of the raw signal on <stream_name>_lfp
+    int rate;               // output rate in Hz, must divide sampling_rate
+    double cutoff;          // anti-aliasing low-pass cutoff in Hz
+    int taps;               // FIR length at the input rate
+};
+
+struct ControlConfig {
+    bool watch;             // re-read the config file when it changes and apply a new filter section
+    double interval;        // seconds of signal between checks of the file
+};
+
+struct PipelineConfig {
+    std::string sample_type;    // "double" or "float", used from the inlet to the model input
+    int threads;        // worker threads, channels are split into one shard per thread
+    bool pin_threads;   // pin each worker to its own core
+    std::string source; // "lsl" or "replay" (sim_data_path as fast as possible, no LSL inlet)
+    int replay_loops;   // passes over the recording in replay mode
 };
 
 struct Config {
@@ -41,6 +108,13 @@ struct Config {
     RecordConfig recording;
     BufferConfig buffer;
     ModelConfig model;
+    PipelineConfig pipeline;
+    NoiseConfig noise;
+    ReferenceConfig reference;
+    DetectorConfig detector;
+    MetricsConfig metrics;
+    LfpConfig lfp;
+    ControlConfig control;
 };
 
 Config readConfig(const std::string& filename);
@@ -23,19 +23,21 @@ bool checkFileType(const std::string& filepath) {
     }
 }
 
-matvar_t* handle_mat_file(mat_t* matfile) {
+matvar_t* handle_mat_file(mat_t* matfile, matvar_t** raw_data) {
     if (!matfile) {
         throw std::runtime_error("Could not open .mat file");
     }
 
-    matvar_t *raw_data = Mat_VarRead(matfile, "rawdata");
-    if (!raw_data) {
+    matvar_t *rawVar = Mat_VarRead(matfile, "rawdata");
+    if (!rawVar) {
         throw std::runtime_error("Could not open .mat file");
     }
 
-    matvar_t *spikeVar = Mat_VarGetStructFieldByName(raw_data, "spike", 0);
+    matvar_t *spikeVar = Mat_VarGetStructFieldByName(rawVar, "spike", 0);
     if (!spikeVar) {
+        Mat_VarFree(rawVar);
         throw std::runtime_error("Could not open .mat file");
     }
+    if (raw_data) *raw_data = rawVar;
     return spikeVar;
 }
\ No newline at end of file
@@ -5,7 +5,9 @@
 
 bool checkFileType(const std::string& filepath);
 
-matvar_t* handle_mat_file(mat_t* matfile);
+// the 'spike' field of the 'rawdata' struct. The field belongs to the struct: pass raw_data to
+// take ownership of it and release it with Mat_VarFree once the spike data is no longer used.
+matvar_t* handle_mat_file(mat_t* matfile, matvar_t** raw_data = nullptr);
 
 
 #endif //SIM_FILE_IO_H
@@ -0,0 +1,286 @@
+#ifndef SIMD_H
+#define SIMD_H
+
+// Thin wrapper around the widest vector ISA enabled at compile time
+// (AVX-512, AVX2 or plain scalar code). Kernels are written once against
+// simd::Vec<T> and pick up the lane count from Vec<T>::width.
+// Vec<int32_t> has as many lanes as Vec<float> and converts from/to int16.
+// reduce_add sums the lanes of a floating point vector, mask_gt sets bit i
+// of its result where lane i of a is greater than of b, min is the
+// lane-wise minimum.
+
+#include <cstdint>
+#include <utility>
+
+#if defined(__AVX512F__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace simd {
+
+template <typename T>
+struct Vec;
+
+#if defined(__AVX512F__)
+
+template <>
+struct Vec<double> {
+    static constexpr int width = 8;
+    __m512d v;
+
+    static Vec zero() { return {_mm512_setzero_pd()}; }
+    static Vec broadcast(double x) { return {_mm512_set1_pd(x)}; }
+    static Vec load(const double *p) { return {_mm512_load_pd(p)}; }
+    static Vec loadu(const double *p) { return {_mm512_loadu_pd(p)}; }
+    void store(double *p) const { _mm512_store_pd(p, v); }
+    void storeu(double *p) const { _mm512_storeu_pd(p, v); }
+
+    friend Vec operator+(Vec a, Vec b) { return {_mm512_add_pd(a.v, b.v)}; }
+    friend Vec operator-(Vec a, Vec b) { return {_mm512_sub_pd(a.v, b.v)}; }
+    friend Vec operator*(Vec a, Vec b) { return {_mm512_mul_pd(a.v, b.v)}; }
+    // a * b + c
+    friend Vec fmadd(Vec a, Vec b, Vec c) { return {_mm512_fmadd_pd(a.v, b.v, c.v)}; }
+    // c - a * b
+    friend Vec fnmadd(Vec a, Vec b, Vec c) { return {_mm512_fnmadd_pd(a.v, b.v, c.v)}; }
+    friend Vec abs(Vec a) { return {_mm512_abs_pd(a.v)}; }
+    friend Vec min(Vec a, Vec b) { return {_mm512_min_pd(a.v, b.v)}; }
+    // a > b ? t : f, per lane
+    friend Vec select_gt(Vec a, Vec b, Vec t, Vec f) { return {_mm512_mask_blend_pd(_mm512_cmp_pd_mask(a.v, b.v, _CMP_GT_OQ), f.v, t.v)}; }
+    friend double reduce_add(Vec a) { return _mm512_reduce_add_pd(a.v); }
+    friend uint32_t mask_gt(Vec a, Vec b) { return _mm512_cmp_pd_mask(a.v, b.v, _CMP_GT_OQ); }
+};
+
+template <>
+struct Vec<float> {
+    static constexpr int width = 16;
+    __m512 v;
+
+    static Vec zero() { return {_mm512_setzero_ps()}; }
+    static Vec broadcast(float x) { return {_mm512_set1_ps(x)}; }
+    static Vec load(const float *p) { return {_mm512_load_ps(p)}; }
+    static Vec loadu(const float *p) { return {_mm512_loadu_ps(p)}; }
+    void store(float *p) const { _mm512_store_ps(p, v); }
+    void storeu(float *p) const { _mm512_storeu_ps(p, v); }
+
+    friend Vec operator+(Vec a, Vec b) { return {_mm512_add_ps(a.v, b.v)}; }
+    friend Vec operator-(Vec a, Vec b) { return {_mm512_sub_ps(a.v, b.v)}; }
+    friend Vec operator*(Vec a, Vec b) { return {_mm512_mul_ps(a.v, b.v)}; }
+    friend Vec fmadd(Vec a, Vec b, Vec c) { return {_mm512_fmadd_ps(a.v, b.v, c.v)}; }
+    friend Vec fnmadd(Vec a, Vec b, Vec c) { return {_mm512_fnmadd_ps(a.v, b.v, c.v)}; }
+    friend Vec abs(Vec a) { return {_mm512_abs_ps(a.v)}; }
+    friend Vec min(Vec a, Vec b) { return {_mm512_min_ps(a.v, b.v)}; }
+    friend Vec select_gt(Vec a, Vec b, Vec t, Vec f) { return {_mm512_mask_blend_ps(_mm512_cmp_ps_mask(a.v, b.v, _CMP_GT_OQ), f.v, t.v)}; }
+    friend float reduce_add(Vec a) { return _mm512_reduce_add_ps(a.v); }
+    friend uint32_t mask_gt(Vec a, Vec b) { return _mm512_cmp_ps_mask(a.v, b.v, _CMP_GT_OQ); }
+};
+
+template <>
+struct Vec<int32_t> {
+    static constexpr int width = 16;
+    __m512i v;
+
+    static Vec zero() { return {_mm512_setzero_si512()}; }
+    static Vec broadcast(int32_t x) { return {_mm512_set1_epi32(x)}; }
+    static Vec load(const int32_t *p) { return {_mm512_load_si512(p)}; }
+    static Vec loadu(const int32_t *p) { return {_mm512_loadu_si512(p)}; }
+    void store(int32_t *p) const { _mm512_store_si512(p, v); }
+    void storeu(int32_t *p) const { _mm512_storeu_si512(p, v); }
+    // width int16 values, sign extended / saturated
+    static Vec load16(const int16_t *p) { return {_mm512_cvtepi16_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)))}; }
+    void store16(int16_t *p) const { _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), _mm512_cvtsepi32_epi16(v)); }
+
+    friend Vec operator+(Vec a, Vec b) { return {_mm512_add_epi32(a.v, b.v)}; }
+    friend Vec operator-(Vec a, Vec b) { return {_mm512_sub_epi32(a.v, b.v)}; }
+    // low 32 bits of the product
+    friend Vec operator*(Vec a, Vec b) { return {_mm512_mullo_epi32(a.v, b.v)}; }
+    // arithmetic shifts
+    friend Vec operator>>(Vec a, int n) { return {_mm512_sra_epi32(a.v, _mm_cvtsi32_si128(n))}; }
+    friend Vec operator<<(Vec a, int n) { return {_mm512_sll_epi32(a.v, _mm_cvtsi32_si128(n))}; }
+    friend Vec min(Vec a, Vec b) { return {_mm512_min_epi32(a.v, b.v)}; }
+    friend Vec max(Vec a, Vec b) { return {_mm512_max_epi32(a.v, b.v)}; }
+};
+
+#elif defined(__AVX2__)
+
+template <>
+struct Vec<double> {
+    static constexpr int width = 4;
+    __m256d v;
+
+    static Vec zero() { return {_mm256_setzero_pd()}; }
+    static Vec broadcast(double x) { return {_mm256_set1_pd(x)}; }
+    static Vec load(const double *p) { return {_mm256_load_pd(p)}; }
+    static Vec loadu(const double *p) { return {_mm256_loadu_pd(p)}; }
+    void store(double *p) const { _mm256_store_pd(p, v); }
+    void storeu(double *p) const { _mm256_storeu_pd(p, v); }
+
+    friend Vec operator+(Vec a, Vec b) { return {_mm256_add_pd(a.v, b.v)}; }
+    friend Vec operator-(Vec a, Vec b) { return {_mm256_sub_pd(a.v, b.v)}; }
+    friend Vec operator*(Vec a, Vec b) { return {_mm256_mul_pd(a.v, b.v)}; }
+#if defined(__FMA__)
+    friend Vec fmadd(Vec a, Vec b, Vec c) { return {_mm256_fmadd_pd(a.v, b.v, c.v)}; }
+    friend Vec fnmadd(Vec a, Vec b, Vec c) { return {_mm256_fnmadd_pd(a.v, b.v, c.v)}; }
+#else
+    friend Vec fmadd(Vec a, Vec b, Vec c) { return a * b + c; }
+    friend Vec fnmadd(Vec a, Vec b, Vec c) { return c - a * b; }
+#endif
+    friend Vec abs(Vec a) { return {_mm256_andnot_pd(_mm256_set1_pd(-0.0), a.v)}; }
+    friend Vec min(Vec a, Vec b) { return {_mm256_min_pd(a.v, b.v)}; }
+    friend Vec select_gt(Vec a, Vec b, Vec t, Vec f) { return {_mm256_blendv_pd(f.v, t.v, _mm256_cmp_pd(a.v, b.v, _CMP_GT_OQ))}; }
+    friend double reduce_add(Vec a) {
+        const __m128d x = _mm_add_pd(_mm256_castpd256_pd128(a.v), _mm256_extractf128_pd(a.v, 1));
+        return _mm_cvtsd_f64(_mm_add_sd(x, _mm_unpackhi_pd(x, x)));
+    }
+    friend uint32_t mask_gt(Vec a, Vec b) { return _mm256_movemask_pd(_mm256_cmp_pd(a.v, b.v, _CMP_GT_OQ)); }
+};
+
+template <>
+struct Vec<float> {
+    static constexpr int width = 8;
+    __m256 v;
+
+    static Vec zero() { return {_mm256_setzero_ps()}; }
+    static Vec broadcast(float x) { return {_mm256_set1_ps(x)}; }
+    static Vec load(const float *p) { return {_mm256_load_ps(p)}; }
+    static Vec loadu(const float *p) { return {_mm256_loadu_ps(p)}; }
+    void store(float *p) const { _mm256_store_ps(p, v); }
+    void storeu(float *p) const { _mm256_storeu_ps(p, v); }
+
+    friend Vec operator+(Vec a, Vec b) { return {_mm256_add_ps(a.v, b.v)}; }
+    friend Vec operator-(Vec a, Vec b) { return {_mm256_sub_ps(a.v, b.v)}; }
+    friend Vec operator*(Vec a, Vec b) { return {_mm256_mul_ps(a.v, b.v)}; }
+#if defined(__FMA__)
+    friend Vec fmadd(Vec a, Vec b, Vec c) { return {_mm256_fmadd_ps(a.v, b.v, c.v)}; }
+    friend Vec fnmadd(Vec a, Vec b, Vec c) { return {_mm256_fnmadd_ps(a.v, b.v, c.v)}; }
+#else
+    friend Vec fmadd(Vec a, Vec b, Vec c) { return a * b + c; }
+    friend Vec fnmadd(Vec a, Vec b, Vec c) { return c - a * b; }
+#endif
+    friend Vec abs(Vec a) { return {_mm256_andnot_ps(_mm256_set1_ps(-0.0f), a.v)}; }
+    friend Vec min(Vec a, Vec b) { return {_mm256_min_ps(a.v, b.v)}; }
+    friend Vec select_gt(Vec a, Vec b, Vec t, Vec f) { return {_mm256_blendv_ps(f.v, t.v, _mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ))}; }
+    friend float reduce_add(Vec a) {
+        __m128 x = _mm_add_ps(_mm256_castps256_ps128(a.v), _mm256_extractf128_ps(a.v, 1));
+        x = _mm_add_ps(x, _mm_movehl_ps(x, x));
+        return _mm_cvtss_f32(_mm_add_ss(x, _mm_movehdup_ps(x)));
+    }
+    friend uint32_t mask_gt(Vec a, Vec b) { return _mm256_movemask_ps(_mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ)); }
+};
+
+template <>
+struct Vec<int32_t> {
+    static constexpr int width = 8;
+    __m256i v;
+
+    static Vec zero() { return {_mm256_setzero_si256()}; }
+    static Vec broadcast(int32_t x) { return {_mm256_set1_epi32(x)}; }
+    static Vec load(const int32_t *p) { return {_mm256_load_si256(reinterpret_cast<const __m256i *>(p))}; }
+    static Vec loadu(const int32_t *p) { return {_mm256_loadu_si256(reinterpret_cast<const __m256i *>(p))}; }
+    void store(int32_t *p) const { _mm256_store_si256(reinterpret_cast<__m256i *>(p), v); }
+    void storeu(int32_t *p) const { _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), v); }
+    static Vec load16(const int16_t *p) { return {_mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p)))}; }
+    void store16(int16_t *p) const {
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(p), _mm_packs_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1)));
+    }
+
+    friend Vec operator+(Vec a, Vec b) { return {_mm256_add_epi32(a.v, b.v)}; }
+    friend Vec operator-(Vec a, Vec b) { return {_mm256_sub_epi32(a.v, b.v)}; }
+    friend Vec operator*(Vec a, Vec b) { return {_mm256_mullo_epi32(a.v, b.v)}; }
+    friend Vec operator>>(Vec a, int n) { return {_mm256_sra_epi32(a.v, _mm_cvtsi32_si128(n))}; }
+    friend Vec operator<<(Vec a, int n) { return {_mm256_sll_epi32(a.v, _mm_cvtsi32_si128(n))}; }
+    friend Vec min(Vec a, Vec b) { return {_mm256_min_epi32(a.v, b.v)}; }
+    friend Vec max(Vec a, Vec b) { return {_mm256_max_epi32(a.v, b.v)}; }
+};
+
+#else
+
+template <>
+struct Vec<double> {
+    static constexpr int width = 1;
+    double v;
+
+    static Vec zero() { return {0.0}; }
+    static Vec broadcast(double x) { return {x}; }
+    static Vec load(const double *p) { return {*p}; }
+    static Vec loadu(const double *p) { return {*p}; }
+    void store(double *p) const { *p = v; }
+    void storeu(double *p) const { *p = v; }
+
+    friend Vec operator+(Vec a, Vec b) { return {a.v + b.v}; }
+    friend Vec operator-(Vec a, Vec b) { return {a.v - b.v}; }
+    friend Vec operator*(Vec a, Vec b) { return {a.v * b.v}; }
+    friend Vec fmadd(Vec a, Vec b, Vec c) { return {a.v * b.v + c.v}; }
+    friend Vec fnmadd(Vec a, Vec b, Vec c) { return {c.v - a.v * b.v}; }
+    friend Vec abs(Vec a) { return {a.v < 0 ? -a.v : a.v}; }
+    friend Vec min(Vec a, Vec b) { return {a.v < b.v ? a.v : b.v}; }
+    friend Vec select_gt(Vec a, Vec b, Vec t, Vec f) { return {a.v > b.v ? t.v : f.v}; }
+    friend double reduce_add(Vec a) { return a.v; }
+    friend uint32_t mask_gt(Vec a, Vec b) { return a.v > b.v; }
+};
+
+template <>
+struct Vec<float> {
+    static constexpr int width = 1;
+    float v;
+
+    static Vec zero() { return {0.0f}; }
+    static Vec broadcast(float x) { return {x}; }
+    static Vec load(const float *p) { return {*p}; }
+    static Vec loadu(const float *p) { return {*p}; }
+    void store(float *p) const { *p = v; }
+    void storeu(float *p) const { *p = v; }
+
+    friend Vec operator+(Vec a, Vec b) { return {a.v + b.v}; }
+    friend Vec operator-(Vec a, Vec b) { return {a.v - b.v}; }
+    friend Vec operator*(Vec a, Vec b) { return {a.v * b.v}; }
+    friend Vec fmadd(Vec a, Vec b, Vec c) { return {a.v * b.v + c.v}; }
+    friend Vec fnmadd(Vec a, Vec b, Vec c) { return {c.v - a.v * b.v}; }
+    friend Vec abs(Vec a) { return {a.v < 0 ? -a.v : a.v}; }
+    friend Vec min(Vec a, Vec b) { return {a.v < b.v ? a.v : b.v}; }
+    friend Vec select_gt(Vec a, Vec b, Vec t, Vec f) { return {a.v > b.v ? t.v : f.v}; }
+    friend float reduce_add(Vec a) { return a.v; }
+    friend uint32_t mask_gt(Vec a, Vec b) { return a.v > b.v; }
+};
+
+template <>
+struct Vec<int32_t> {
+    static constexpr int width = 1;
+    int32_t v;
+
+    static Vec zero() { return {0}; }
+    static Vec broadcast(int32_t x) { return {x}; }
+    static Vec load(const int32_t *p) { return {*p}; }
+    static Vec loadu(const int32_t *p) { return {*p}; }
+    void store(int32_t *p) const { *p = v; }
+    void storeu(int32_t *p) const { *p = v; }
+    static Vec load16(const int16_t *p) { return {*p}; }
+    void store16(int16_t *p) const { *p = static_cast<int16_t>(v < INT16_MIN ? INT16_MIN : v > INT16_MAX ? INT16_MAX : v); }
+
+    friend Vec operator+(Vec a, Vec b) { return {a.v + b.v}; }
+    friend Vec operator-(Vec a, Vec b) { return {a.v - b.v}; }
+    friend Vec operator*(Vec a, Vec b) { return {a.v * b.v}; }
+    friend Vec operator>>(Vec a, int n) { return {a.v >> n}; }
+    friend Vec operator<<(Vec a, int n) { return {a.v << n}; }
+    friend Vec min(Vec a, Vec b) { return {a.v < b.v ? a.v : b.v}; }
+    friend Vec max(Vec a, Vec b) { return {a.v > b.v ? a.v : b.v}; }
+};
+
+#endif
+
+// calls f(std::integral_constant<int, i>) for i = 0 .. N-1, unrolled by the compiler
+template <int N, typename F>
+inline void unrolled(F &&f) {
+    [&]<int... I>(std::integer_sequence<int, I...>) {
+        (f(std::integral_constant<int, I>{}), ...);
+    }(std::make_integer_sequence<int, N>{});
+}
+
+// number of elements needed to hold n values in whole vectors
+template <typename T>
+constexpr int padded(int n) {
+    return (n + Vec<T>::width - 1) / Vec<T>::width * Vec<T>::width;
+}
+
+} // namespace simd
+
+#endif //SIMD_H
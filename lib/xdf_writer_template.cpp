@@ -10,7 +10,7 @@ void write_header(XDFWriter* writer, const Config& cfg ) {
         << "<type>EEG</type>"
         << "<channel_count>" << cfg.n_channel << "</channel_count>"
         << "<nominal_srate>" << cfg.sampling_rate << "</nominal_srate>"
-        << "<channel_format>" << "double64" << "</channel_format>"
+        << "<channel_format>" << (cfg.pipeline.sample_type == "float" ? "float32" : "double64") << "</channel_format>"
         << "<created_at>50942.723319709003</created_at>"
         << "</info>";
 
@@ -40,6 +40,7 @@ public:
     void setPeakGain(double peakGainDB);
     void setBiquad(int type, double Fc, double Q, double peakGainDB);
     double process(double in);
+    void getCoefficients(double &a0, double &a1, double &a2, double &b1, double &b2) const;
     
 protected:
     void calcBiquad(void);
@@ -57,4 +58,12 @@ inline double Biquad::process(double in) {
     return out;
 }
 
+inline void Biquad::getCoefficients(double &a0, double &a1, double &a2, double &b1, double &b2) const {
+    a0 = this->a0;
+    a1 = this->a1;
+    a2 = this->a2;
+    b1 = this->b1;
+    b2 = this->b2;
+}
+
 #endif // Biquad_h
@@ -0,0 +1,184 @@
+#include "BiquadBank.h"
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+#include "Biquad.h"
+#include "../../lib/simd.h"
+
+IirMode parseIirMode(const std::string &name) {
+    if (name == "auto") return IirMode::automatic;
+    if (name == "channel") return IirMode::channel;
+    if (name == "time") return IirMode::time;
+    throw std::invalid_argument("Unsupported IIR mode: " + name);
+}
+
+template <typename T>
+BiquadBank<T>::BiquadBank(int n_channel, int n_sections, IirMode mode)
+    : n_channel(n_channel), n_padded(simd::padded<T>(n_channel)), n_sections(0) {
+    setMode(mode);
+    setSections(SosCascade(n_sections, SosSection{1, 0, 0, 0, 0}));
+}
+
+template <typename T>
+void BiquadBank<T>::setMode(IirMode mode) {
+    // blocks need at least two samples (scalar builds always filter per channel)
+    constexpr int block = simd::Vec<T>::width;
+    time_parallel = block >= 2 and (mode == IirMode::time or (mode == IirMode::automatic and n_channel < block));
+    if (time_parallel and !cascade.empty()) computeBlockResponses();
+}
+
+template <typename T>
+void BiquadBank<T>::setBiquad(int type, double Fc, double Q, double peakGainDB) {
+    // Biquad names the numerator a0..a2 and the denominator b1, b2
+    double c0, c1, c2, d1, d2;
+    Biquad(type, Fc, Q, peakGainDB).getCoefficients(c0, c1, c2, d1, d2);
+    setSections(SosCascade{{c0, c1, c2, d1, d2}});
+}
+
+template <typename T>
+void BiquadBank<T>::setSections(const SosCascade &sections) {
+    if (sections.empty()) throw std::invalid_argument("BiquadBank needs at least one section");
+    cascade = sections;
+    if (static_cast<int>(cascade.size()) != n_sections) {
+        n_sections = static_cast<int>(cascade.size());
+        z1.assign(static_cast<size_t>(n_sections) * n_padded, 0);
+        z2.assign(static_cast<size_t>(n_sections) * n_padded, 0);
+        kernel = selectIirKernel<T>(n_sections);
+        detect_kernel = selectIirDetectKernel<T>(n_sections);
+    }
+    b0.resize(n_sections);
+    b1.resize(n_sections);
+    b2.resize(n_sections);
+    a1.resize(n_sections);
+    a2.resize(n_sections);
+    for (int section = 0; section < n_sections; section++) {
+        b0[section] = static_cast<T>(cascade[section].b0);
+        b1[section] = static_cast<T>(cascade[section].b1);
+        b2[section] = static_cast<T>(cascade[section].b2);
+        a1[section] = static_cast<T>(cascade[section].a1);
+        a2[section] = static_cast<T>(cascade[section].a2);
+    }
+    if (time_parallel) computeBlockResponses();
+}
+
+template <typename T>
+void BiquadBank<T>::computeBlockResponses() {
+    // simulate the cascade in double over one block for each unit input and each unit state
+    constexpr int L = simd::Vec<T>::width;
+    const int n_states = 2 * n_sections;
+    state_width = simd::padded<T>(n_states);
+    responses.assign(static_cast<size_t>(L + n_states) * L, 0);
+    transitions.assign(static_cast<size_t>(L + n_states) * state_width, 0);
+    state.assign(state_width, 0);
+    next_state.assign(state_width, 0);
+    std::vector<double> z(n_states);
+    for (int column = 0; column < L + n_states; column++) {
+        std::fill(z.begin(), z.end(), 0.0);
+        if (column >= L) z[column - L] = 1.0;
+        for (int i = 0; i < L; i++) {
+            double y = column == i ? 1.0 : 0.0;
+            for (int section = 0; section < n_sections; section++) y = processSection(cascade[section], &z[2 * section], y);
+            responses[static_cast<size_t>(column) * L + i] = static_cast<T>(y);
+        }
+        for (int j = 0; j < n_states; j++) transitions[static_cast<size_t>(column) * state_width + j] = static_cast<T>(z[j]);
+    }
+}
+
+template <typename T>
+void BiquadBank<T>::processChunk(const T *in, T *out, int n_samples, int stride) {
+    if (time_parallel) {
+        processAlongTime(in, out, n_samples, stride);
+        return;
+    }
+    kernel({b0.data(), b1.data(), b2.data(), a1.data(), a2.data(), z1.data(), z2.data(), n_sections, n_channel, n_padded},
+           in, out, n_samples, stride);
+}
+
+template <typename T>
+void BiquadBank<T>::processChunkDetect(const T *in, T *out, int n_samples, int stride, const NoiseView<T> &noise,
+                                       uint32_t *crossings) {
+    if (time_parallel) {
+        processAlongTime(in, out, n_samples, stride);
+        updateNoiseAndDetect(noise, out, n_samples, stride, n_channel, crossings);
+        return;
+    }
+    detect_kernel({b0.data(), b1.data(), b2.data(), a1.data(), a2.data(), z1.data(), z2.data(), n_sections, n_channel, n_padded},
+                  noise, in, out, n_samples, stride, crossings);
+}
+
+template <typename T>
+void BiquadBank<T>::processAlongTime(const T *in, T *out, int n_samples, int stride) {
+    using V = simd::Vec<T>;
+    constexpr int L = V::width;
+    const int n_states = 2 * n_sections;
+    const int n_blocks = n_samples / L;
+    if (scratch.size() < static_cast<size_t>(n_samples)) scratch.resize(n_samples);
+    T *x = scratch.data();
+    const T *response = responses.data(), *transition = transitions.data();
+
+    for (int c = 0; c < n_channel; c++) {
+        for (int s = 0; s < n_samples; s++) x[s] = in[s * stride + c];
+        T *current = state.data(), *next = next_state.data();
+        for (int section = 0; section < n_sections; section++) {
+            current[2 * section] = z1[section * n_padded + c];
+            current[2 * section + 1] = z2[section * n_padded + c];
+        }
+
+        for (int b = 0; b < n_blocks; b++) {
+            T *u = x + b * L;
+
+            // next state: transition of the current state plus the inputs' contribution,
+            // two chains each so the dependency from block to block stays short
+            for (int v = 0; v < state_width; v += L) {
+                const T *tr = transition + v;
+                V acc0 = V::zero(), acc1 = V::zero(), acc2 = V::zero(), acc3 = V::zero();
+                for (int k = 0; k < L; k += 2) {
+                    acc0 = fmadd(V::broadcast(u[k]), V::load(tr + k * state_width), acc0);
+                    acc1 = fmadd(V::broadcast(u[k + 1]), V::load(tr + (k + 1) * state_width), acc1);
+                }
+                for (int j = 0; j < n_states; j += 2) {
+                    acc2 = fmadd(V::broadcast(current[j]), V::load(tr + (L + j) * state_width), acc2);
+                    acc3 = fmadd(V::broadcast(current[j + 1]), V::load(tr + (L + j + 1) * state_width), acc3);
+                }
+                ((acc0 + acc1) + (acc2 + acc3)).store(next + v);
+            }
+
+            // outputs: zero-state response plus zero-input response
+            V y0 = V::zero(), y1 = V::zero(), y2 = V::zero(), y3 = V::zero();
+            for (int k = 0; k < L; k += 2) {
+                y0 = fmadd(V::broadcast(u[k]), V::load(response + k * L), y0);
+                y1 = fmadd(V::broadcast(u[k + 1]), V::load(response + (k + 1) * L), y1);
+            }
+            for (int j = 0; j < n_states; j += 2) {
+                y2 = fmadd(V::broadcast(current[j]), V::load(response + (L + j) * L), y2);
+                y3 = fmadd(V::broadcast(current[j + 1]), V::load(response + (L + j + 1) * L), y3);
+            }
+            ((y0 + y1) + (y2 + y3)).store(u);
+            std::swap(current, next);
+        }
+
+        for (int section = 0; section < n_sections; section++) {
+            z1[section * n_padded + c] = current[2 * section];
+            z2[section * n_padded + c] = current[2 * section + 1];
+        }
+
+        // remaining samples one at a time
+        for (int section = 0; section < n_sections; section++) {
+            T s1 = z1[section * n_padded + c], s2 = z2[section * n_padded + c];
+            for (int s = n_blocks * L; s < n_samples; s++) {
+                const T xs = x[s];
+                const T y = xs * b0[section] + s1;
+                s1 = xs * b1[section] + s2 - a1[section] * y;
+                s2 = xs * b2[section] - a2[section] * y;
+                x[s] = y;
+            }
+            z1[section * n_padded + c] = s1;
+            z2[section * n_padded + c] = s2;
+        }
+
+        for (int s = 0; s < n_samples; s++) out[s * stride + c] = x[s];
+    }
+}
+
+template class BiquadBank<float>;
+template class BiquadBank<double>;
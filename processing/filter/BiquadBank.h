@@ -0,0 +1,88 @@
+#ifndef BIQUAD_BANK_H
+#define BIQUAD_BANK_H
+
+#include <string>
+#include "../../lib/aligned_allocator.h"
+#include "filter_kernels.h"
+#include "sos.h"
+
+// channel: one SIMD lane per channel. time: each channel is vectorised along
+// time in blocks (for banks with fewer channels than a vector has lanes).
+// automatic picks time for such banks, channel otherwise.
+enum class IirMode { automatic, channel, time };
+IirMode parseIirMode(const std::string &name);
+
+// Bank of one cascade of second order sections per channel. All channels
+// share the coefficients (one set per section, broadcast into registers),
+// only the z1/z2 state is per channel and lives in contiguous aligned arrays
+// (section-major), so a time step is filtered for simd::Vec<T>::width
+// channels per instruction and memory stays flat as channels grow. Sections
+// are evaluated in transposed direct form II, coefficients are designed in
+// double precision and stored in the sample type T.
+//
+// With few channels the lanes stay empty, so the time mode treats the whole
+// cascade as one linear system with the 2 * n_sections z1/z2 values as state
+// and steps it by blocks of L = simd::Vec<T>::width samples: the L outputs
+// are the zero-state response (lower triangular Toeplitz matrix of the
+// impulse response times the L inputs) plus the zero-input response of the
+// state, the next state is the state transition over L samples plus the
+// inputs' contribution. Both are sums of broadcast inputs/states times
+// precomputed columns, i.e. vectorised along time, and the serial dependency
+// is one block instead of one sample per section long.
+template <typename T>
+class BiquadBank {
+public:
+    explicit BiquadBank(int n_channel, int n_sections = 1, IirMode mode = IirMode::automatic);
+
+    // replaces the cascade with one Biquad (same parameters as Biquad::setBiquad)
+    void setBiquad(int type, double Fc, double Q, double peakGainDB);
+
+    // replaces the cascade, e.g. with IIR_Filter::getSections().
+    // Changing the number of sections resets the filter state.
+    void setSections(const SosCascade &cascade);
+
+    // switches between the channel and the time engine, both run on the same
+    // z1/z2 state, so the filter continues without a transient
+    void setMode(IirMode mode);
+
+    // Filters n_samples time steps. in/out point to the first channel of the
+    // first sample, consecutive samples are `stride` values apart.
+    void processChunk(const T *in, T *out, int n_samples, int stride);
+
+    // processChunk fused with the noise update and threshold comparison of
+    // every output (IirKernel::processDetect); the time mode runs them as a
+    // second pass over the filtered chunk
+    void processChunkDetect(const T *in, T *out, int n_samples, int stride, const NoiseView<T> &noise,
+                            uint32_t *crossings);
+
+    // filters a single time step of all channels
+    void process(const T *in, T *out) { processChunk(in, out, 1, n_channel); }
+
+    [[nodiscard]] int getChannelCount() const { return n_channel; }
+    [[nodiscard]] int getSectionCount() const { return n_sections; }
+    [[nodiscard]] bool isTimeParallel() const { return time_parallel; }
+
+private:
+    int n_channel;
+    int n_padded;
+    int n_sections;
+    aligned_vector<T> b0, b1, b2, a1, a2;   // [section]
+    aligned_vector<T> z1, z2;               // [section * n_padded + channel]
+    SosCascade cascade;                     // the sections in double, for the time mode block responses
+    IirKernelFn<T> kernel;                  // specialised for n_sections, chosen in setSections
+    IirDetectKernelFn<T> detect_kernel;
+
+    // time mode
+    bool time_parallel;
+    int state_width;                        // 2 * n_sections padded to whole vectors
+    // columns for the L inputs, then for the 2 * n_sections states (z1, z2 per section)
+    aligned_vector<T> responses;            // [column][L] outputs of the block
+    aligned_vector<T> transitions;          // [column][state_width] state after the block
+    aligned_vector<T> scratch;              // one channel of the chunk
+    aligned_vector<T> state, next_state;    // [state_width]
+
+    void computeBlockResponses();
+    void processAlongTime(const T *in, T *out, int n_samples, int stride);
+};
+
+#endif //BIQUAD_BANK_H
@@ -0,0 +1,271 @@
+#include "CommonReference.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include "../../lib/simd.h"
+
+ReferenceMode parseReferenceMode(const std::string &name) {
+    if (name == "none") return ReferenceMode::none;
+    if (name == "average") return ReferenceMode::average;
+    if (name == "median") return ReferenceMode::median;
+    throw std::invalid_argument("Unsupported reference mode: " + name);
+}
+
+std::vector<std::vector<int>> readLayout(const std::string &path) {
+    std::ifstream file(path);
+    if (!file) throw std::runtime_error("Cannot open layout file: " + path);
+    std::vector<std::vector<int>> layout;
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() or line == "\r") continue;
+        std::vector<int> row;
+        std::stringstream ss(line);
+        std::string value;
+        while (std::getline(ss, value, ';')) row.push_back(std::stoi(value));
+        layout.push_back(std::move(row));
+    }
+    return layout;
+}
+
+std::vector<std::vector<int>> layoutGroups(const std::vector<std::vector<int>> &layout, int n_channel, int block) {
+    std::vector<std::vector<int>> groups;
+    size_t n_cols = 0;
+    for (const auto &layout_row : layout) n_cols = std::max(n_cols, layout_row.size());
+    const size_t block_rows = block > 0 ? block : std::max<size_t>(layout.size(), 1);
+    const size_t block_cols = block > 0 ? block : std::max<size_t>(n_cols, 1);
+
+    for (size_t r0 = 0; r0 < layout.size(); r0 += block_rows) {
+        for (size_t c0 = 0; c0 < n_cols; c0 += block_cols) {
+            std::vector<int> group;
+            for (size_t r = r0; r < std::min(r0 + block_rows, layout.size()); r++) {
+                for (size_t c = c0; c < std::min(c0 + block_cols, layout[r].size()); c++) {
+                    const int channel = layout[r][c];
+                    if (channel > 0 and channel <= n_channel) group.push_back(channel - 1);
+                }
+            }
+            if (!group.empty()) groups.push_back(std::move(group));
+        }
+    }
+    return groups;
+}
+
+template <typename T>
+CommonReference<T>::CommonReference(int n_channel, const std::vector<std::vector<int>> &groups, ReferenceMode mode,
+                                    double resolution)
+    : n_channel(n_channel), n_padded(simd::padded<T>(n_channel)), n_groups(static_cast<int>(groups.size())), mode(mode),
+      resolution(static_cast<T>(resolution)), members(static_cast<size_t>(n_groups) * n_padded, T(0)),
+      group_size(n_groups, T(1)), vector_groups(n_channel / simd::Vec<T>::width), median_groups(n_groups) {
+    if (!(resolution > 0.0)) throw std::invalid_argument("Reference median resolution must be positive");
+    constexpr int W = simd::Vec<T>::width;
+    const int n_whole = n_channel / W * W;
+    std::vector<bool> assigned(n_channel, false);
+    for (int group = 0; group < n_groups; group++) {
+        MedianGroup &median_group = median_groups[group];
+        for (int channel : groups[group]) {
+            if (channel < 0 or channel >= n_channel) {
+                throw std::invalid_argument("Reference group channel " + std::to_string(channel) + " out of range");
+            }
+            if (assigned[channel]) {
+                throw std::invalid_argument("Channel " + std::to_string(channel) + " is in more than one reference group");
+            }
+            assigned[channel] = true;
+            members[static_cast<size_t>(group) * n_padded + channel] = T(1);
+            if (channel >= n_whole) median_group.tail.push_back(channel);
+        }
+        if (!groups[group].empty()) group_size[group] = static_cast<T>(groups[group].size());
+
+        for (int offset = 0; offset < n_whole; offset += W) {
+            const T *lanes = &members[static_cast<size_t>(group) * n_padded + offset];
+            if (std::any_of(lanes, lanes + W, [](T member) { return member != T(0); })) {
+                vector_groups[offset / W].push_back(group);
+                median_group.offsets.push_back(offset);
+                median_group.weights.insert(median_group.weights.end(), lanes, lanes + W);
+            }
+        }
+        median_group.need = static_cast<int>(groups[group].size() + 1) / 2;
+        median_group.gap = this->resolution;
+    }
+    single_group = n_groups == 1 and static_cast<int>(groups[0].size()) == n_channel;
+}
+
+template <typename T>
+template <int R>
+void CommonReference<T>::countBelow(const MedianGroup &group, const T *const *rows, const T *values, int *counts) const {
+    using V = simd::Vec<T>;
+    // the counts of all rows stay in registers, one compare and masked add per vector and row
+    V middle[R], below[R];
+    const T *row[R];
+    int tail[R];
+    simd::unrolled<R>([&](auto r) {
+        middle[r] = V::broadcast(values[r]);
+        below[r] = V::zero();
+        row[r] = rows[r];
+        tail[r] = 0;
+    });
+    const size_t n_vectors = group.offsets.size();
+    for (size_t v = 0; v < n_vectors; v++) {
+        const int offset = group.offsets[v];
+        const V weight = V::load(&group.weights[v * V::width]);
+        simd::unrolled<R>([&](auto r) { below[r] = below[r] + select_gt(middle[r], V::loadu(row[r] + offset), weight, V::zero()); });
+    }
+    for (int channel : group.tail) {
+        simd::unrolled<R>([&](auto r) { tail[r] += row[r][channel] < values[r]; });
+    }
+    simd::unrolled<R>([&](auto r) { counts[r] = static_cast<int>(reduce_add(below[r])) + tail[r]; });
+}
+
+template <typename T>
+T CommonReference<T>::searchMedian(const MedianGroup &group, const T *row, T low, T high) const {
+    // the bracket is valid while fewer than `need` channels are below low and at least `need` below high;
+    // the step limits only matter for values that do not compare (NaN)
+    constexpr int max_steps = 256;
+    const auto below = [&](T value) {
+        int count;
+        countBelow<1>(group, &row, &value, &count);
+        return count;
+    };
+    T step = std::max(high - low, resolution);
+    if (below(low) >= group.need) {
+        high = low;
+        low = high - step;
+        for (int k = 0; k < max_steps and below(low) >= group.need; k++) {
+            high = low;
+            step *= 2;
+            low = high - step;
+        }
+    } else if (below(high) < group.need) {
+        low = high;
+        high = low + step;
+        for (int k = 0; k < max_steps and below(high) < group.need; k++) {
+            low = high;
+            step *= 2;
+            high = low + step;
+        }
+    }
+    for (int k = 0; k < max_steps and high - low > resolution; k++) {
+        const T middle = (low + high) * T(0.5);
+        (below(middle) < group.need ? low : high) = middle;
+    }
+    return (low + high) * T(0.5);
+}
+
+template <typename T>
+void CommonReference<T>::groupMedians(int group, const T *in, int first_sample, int n_rows) {
+    constexpr int R = median_rows;
+    MedianGroup &median_group = median_groups[group];
+    if (median_group.need == 0) {
+        // an empty group references no channel
+        for (int r = 0; r < n_rows; r++) references[static_cast<size_t>(first_sample + r) * n_groups + group] = 0;
+        return;
+    }
+    const T *rows[R];
+    for (int r = 0; r < R; r++) rows[r] = in + static_cast<size_t>(first_sample + std::min(r, n_rows - 1)) * n_channel;
+
+    // one count per time step at the predicted median, the correction is the
+    // count's distance from the middle times the gap between neighbouring channels
+    const T half = group_size[group] * T(0.5);
+    const T band = std::max(T(1), group_size[group] * T(0.375));
+    T predicted[R];
+    int counts[R];
+    for (int r = 0; r < R; r++) predicted[r] = median_group.previous + median_group.slope * T(r + 1);
+    countBelow<R>(median_group, rows, predicted, counts);
+    for (int r = 0; r < n_rows; r++) {
+        const T deficit = half - T(counts[r]);
+        T median;
+        if (std::abs(deficit) <= band) {
+            median = predicted[r] + deficit * median_group.gap;
+        } else {
+            // too far off for the linear correction (start, artefact): search to the resolution
+            const T width = band * median_group.gap;
+            median = searchMedian(median_group, rows[r], predicted[r] - width, predicted[r] + width);
+        }
+        references[static_cast<size_t>(first_sample + r) * n_groups + group] = median;
+    }
+
+    // the gap from the channels within +-h of the last median, outliers beyond do not count
+    const T last = references[static_cast<size_t>(first_sample + n_rows - 1) * n_groups + group];
+    if (!std::isfinite(last)) {
+        // rows that do not compare (NaN) start the estimate over
+        median_group.previous = median_group.slope = 0;
+        median_group.gap = resolution;
+        return;
+    }
+    const T h = std::max(band * median_group.gap * T(0.5), resolution * T(0.5));
+    const T probes[2] = {last - h, last + h};
+    const T *probe_rows[2] = {rows[n_rows - 1], rows[n_rows - 1]};
+    int spread[2];
+    countBelow<2>(median_group, probe_rows, probes, spread);
+    const T gap = median_group.gap;
+    const T measured = spread[1] > spread[0] ? 2 * h / T(spread[1] - spread[0]) : 2 * gap;
+    median_group.gap = std::max(gap + (std::clamp(measured, gap * T(0.5), gap * T(2)) - gap) * T(0.25),
+                                resolution / group_size[group]);
+    median_group.slope += ((last - median_group.previous) / T(n_rows) - median_group.slope) * T(0.25);
+    median_group.previous = last;
+}
+
+template <typename T>
+void CommonReference<T>::processChunk(const T *in, T *out, int n_samples) {
+    using V = simd::Vec<T>;
+    if (mode == ReferenceMode::none or n_groups == 0) {
+        if (in != out) std::memcpy(out, in, sizeof(T) * n_samples * n_channel);
+        return;
+    }
+
+    // first the references of all time steps, then one subtraction pass over the chunk
+    references.resize(static_cast<size_t>(n_samples) * n_groups);
+    if (mode == ReferenceMode::median) {
+        for (int s = 0; s < n_samples; s += median_rows) {
+            for (int group = 0; group < n_groups; group++) groupMedians(group, in, s, std::min(median_rows, n_samples - s));
+        }
+    } else {
+        for (int s = 0; s < n_samples; s++) {
+            const T *x = in + static_cast<size_t>(s) * n_channel;
+            for (int group = 0; group < n_groups; group++) {
+                const T *mask = &members[static_cast<size_t>(group) * n_padded];
+                V sum = V::zero();
+                T tail = 0;
+                int c = 0;
+                if (single_group) {
+                    for (; c + V::width <= n_channel; c += V::width) sum = sum + V::loadu(x + c);
+                    for (; c < n_channel; c++) tail += x[c];
+                } else {
+                    for (; c + V::width <= n_channel; c += V::width) sum = fmadd(V::load(mask + c), V::loadu(x + c), sum);
+                    for (; c < n_channel; c++) tail += mask[c] * x[c];
+                }
+                references[static_cast<size_t>(s) * n_groups + group] = (reduce_add(sum) + tail) / group_size[group];
+            }
+        }
+    }
+
+    for (int s = 0; s < n_samples; s++) {
+        const T *x = in + static_cast<size_t>(s) * n_channel;
+        const T *reference = &references[static_cast<size_t>(s) * n_groups];
+        T *y = out + static_cast<size_t>(s) * n_channel;
+        int c = 0;
+        if (single_group) {
+            const V m = V::broadcast(reference[0]);
+            for (; c + V::width <= n_channel; c += V::width) (V::loadu(x + c) - m).storeu(y + c);
+            for (; c < n_channel; c++) y[c] = x[c] - reference[0];
+            continue;
+        }
+        for (; c + V::width <= n_channel; c += V::width) {
+            V value = V::loadu(x + c);
+            for (int group : vector_groups[c / V::width]) {
+                value = fnmadd(V::broadcast(reference[group]), V::load(&members[static_cast<size_t>(group) * n_padded + c]), value);
+            }
+            value.storeu(y + c);
+        }
+        for (; c < n_channel; c++) {
+            T value = x[c];
+            for (int group = 0; group < n_groups; group++) value -= reference[group] * members[static_cast<size_t>(group) * n_padded + c];
+            y[c] = value;
+        }
+    }
+}
+
+template class CommonReference<float>;
+template class CommonReference<double>;
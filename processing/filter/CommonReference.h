@@ -0,0 +1,87 @@
+#ifndef COMMON_REFERENCE_H
+#define COMMON_REFERENCE_H
+
+#include <string>
+#include <vector>
+#include "../../lib/aligned_allocator.h"
+
+enum class ReferenceMode { none, average, median };
+ReferenceMode parseReferenceMode(const std::string &name);
+
+// Common average / common median re-referencing of channel-interleaved
+// chunks: every sample of a channel has the reference of its electrode group
+// at that time step subtracted. Channels that belong to no group pass
+// unchanged.
+//
+// The mean of a time step is one pass over its row with simd::Vec<T>::width
+// channels per instruction. Group membership is a 0 / 1 mask per group, so
+// the group means are masked sums and a few groups cost a few extra vector
+// operations instead of gathers.
+//
+// The median is approximated from one count per time step: the number of
+// the group's channels below the median predicted from the previous time
+// steps (last median plus slope, following LFP and hum), one compare and
+// masked add per vector of channels, straight on the channel-interleaved
+// row. Its distance from half the group, times the gap between neighbouring
+// channels around the median, is the correction of the prediction. The gap
+// is measured once per median_rows time steps by counting the channels
+// within a window around the median. An outlier moves a count by at most
+// one, so it moves the median by at most one gap, as for the exact median.
+// When the count is too far from the middle for the linear correction (the
+// first time steps, artefacts) the row is searched by bisection to a fixed
+// absolute resolution instead. median_rows time steps are counted together.
+template <typename T>
+class CommonReference {
+public:
+    static constexpr int median_rows = 8;
+
+    // groups holds 0-based channel indices, resolution is in input units
+    CommonReference(int n_channel, const std::vector<std::vector<int>> &groups, ReferenceMode mode,
+                    double resolution = 1.0);
+
+    // in and out are [n_samples][n_channel], they may be the same buffer
+    void processChunk(const T *in, T *out, int n_samples);
+
+    [[nodiscard]] int getGroupCount() const { return n_groups; }
+
+private:
+    int n_channel;
+    int n_padded;
+    int n_groups;
+    ReferenceMode mode;
+    bool single_group;              // one group of all channels, no masks needed
+    T resolution;
+    aligned_vector<T> members;      // [group][n_padded] 1 for the group's channels, 0 otherwise
+    std::vector<T> group_size;      // [group] number of channels
+    std::vector<T> references;      // [sample][group] references of the current chunk
+    std::vector<std::vector<int>> vector_groups;    // [vector] groups with channels in that vector of a row
+
+    struct MedianGroup {
+        std::vector<int> offsets;       // first channel of each vector with channels of the group
+        aligned_vector<T> weights;      // [vector][width] 1 for the group's lanes in that vector, 0 otherwise
+        std::vector<int> tail;          // channels after the last whole vector
+        int need;                       // channels below a value above the median, (size + 1) / 2
+        T previous = 0;                 // last median
+        T slope = 0;                    // change of the median per time step
+        T gap = 0;                      // distance between neighbouring channels around the median
+    };
+    std::vector<MedianGroup> median_groups;
+
+    // medians of a group for the time steps first_sample .. first_sample + n_rows - 1 (n_rows <= median_rows)
+    void groupMedians(int group, const T *in, int first_sample, int n_rows);
+    // counts[r]: channels of the group below values[r] in rows[r]
+    template <int R>
+    void countBelow(const MedianGroup &group, const T *const *rows, const T *values, int *counts) const;
+    // median of one row to the resolution, the bracket [low, high] is widened if it misses
+    T searchMedian(const MedianGroup &group, const T *row, T low, T high) const;
+};
+
+// reads a layout file: one row of the electrode grid per line, ';' separated
+std::vector<std::vector<int>> readLayout(const std::string &path);
+
+// Groups from an electrode layout (rows of 1-based channel numbers, 0 for no
+// channel): square blocks of block x block electrodes, or the whole layout
+// for block 0. Channel numbers above n_channel are skipped.
+std::vector<std::vector<int>> layoutGroups(const std::vector<std::vector<int>> &layout, int n_channel, int block);
+
+#endif //COMMON_REFERENCE_H
@@ -0,0 +1,92 @@
+#include "Decimating_FIR_Filter.h"
+#include <map>
+#include <mutex>
+#include <stdexcept>
+
+// Polyphase layout of the taps, shared like the taps themselves: branch p
+// holds h[q * decimation + p] for q = branch_length - 1 .. 0, zero padded, so
+// every branch has the same length and its dot product has a fixed trip count.
+static std::shared_ptr<const std::vector<double>> polyphaseBranches(const std::shared_ptr<const FilterCoefficients> &coefficients,
+                                                                   int decimation, int branch_length) {
+    static std::mutex mutex;
+    static std::map<std::pair<const FilterCoefficients *, int>, std::shared_ptr<const std::vector<double>>> cache;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto &entry = cache[{coefficients.get(), decimation}];
+    if (!entry) {
+        const aligned_vector<double> &h = coefficients->taps;
+        auto branches = std::make_shared<std::vector<double>>(static_cast<size_t>(decimation) * branch_length, 0.0);
+        for (int p = 0; p < decimation; p++) {
+            for (int q = 0; q < branch_length; q++) {
+                const size_t tap = static_cast<size_t>(q) * decimation + p;
+                if (tap < h.size()) (*branches)[static_cast<size_t>(p) * branch_length + branch_length - 1 - q] = h[tap];
+            }
+        }
+        entry = std::move(branches);
+    }
+    return entry;
+}
+
+Decimating_FIR_Filter::Decimating_FIR_Filter(int order, double sampling_rate, BandType band, double low_cut_off,
+                                             double high_cut_off, int decimation, FirWindow window)
+    : Filter(order, sampling_rate, band, low_cut_off, high_cut_off), window(window), decimation(decimation), head(0), phase(0), accumulator(0), output(0), new_output(false) {
+    if (decimation < 1) throw std::invalid_argument("Decimation factor must be at least 1");
+    Decimating_FIR_Filter::calculateCoefficients();
+    branch_length = static_cast<int>((getCoefficients().size() + decimation - 1) / decimation);
+    branches = polyphaseBranches(coefficients, decimation, branch_length);
+    delay.assign(2 * static_cast<size_t>(decimation) * branch_length, 0.0);
+}
+
+void Decimating_FIR_Filter::calculateCoefficients() {
+    coefficients = getFilterCoefficients({FilterClass::fir, getOrder(), getBandType(), getLowCutOff(), getHighCutOff(),
+                                          getSamplingRate(), IirFamily::butterworth, 0, 0, window});
+}
+
+double Decimating_FIR_Filter::push(double data_in) {
+    // input n belongs to output ceil(n / decimation), `phase` samples before it.
+    // Each input is stored at head and head + branch_length, so the last
+    // branch_length inputs of the branch are contiguous, oldest first.
+    double *line = &delay[2 * static_cast<size_t>(phase) * branch_length];
+    line[head] = data_in;
+    line[head + branch_length] = data_in;
+
+    const double *taps = &(*branches)[static_cast<size_t>(phase) * branch_length];
+    const double *window = line + head + 1;
+    // two partial sums halve the chain of dependent additions
+    double sum0 = 0.0, sum1 = 0.0;
+    int q = 0;
+    for (; q + 1 < branch_length; q += 2) {
+        sum0 += taps[q] * window[q];
+        sum1 += taps[q + 1] * window[q + 1];
+    }
+    if (q < branch_length) sum0 += taps[q] * window[q];
+    accumulator += sum0 + sum1;
+
+    new_output = phase == 0;
+    if (new_output) {
+        output = accumulator;
+        accumulator = 0.0;
+        head = (head + 1) % branch_length;
+        phase = decimation - 1;
+    } else {
+        phase--;
+    }
+    return output;
+}
+
+double Decimating_FIR_Filter::calculateOutput(double data_in) {
+    return push(data_in);
+}
+
+template <typename T>
+int Decimating_FIR_Filter::processBlock(const T *in, int n_samples, int stride, T *out, int out_stride) {
+    int n_out = 0;
+    for (int s = 0; s < n_samples; s++) {
+        const double y = push(in[s * stride]);
+        if (new_output) out[n_out++ * out_stride] = static_cast<T>(y);
+    }
+    return n_out;
+}
+
+template int Decimating_FIR_Filter::processBlock<float>(const float *, int, int, float *, int);
+template int Decimating_FIR_Filter::processBlock<double>(const double *, int, int, double *, int);
@@ -0,0 +1,53 @@
+#ifndef DECIMATING_FIR_FILTER_H
+#define DECIMATING_FIR_FILTER_H
+
+#include <memory>
+#include <vector>
+#include "Filter.h"
+#include "filter_coefficients.h"
+
+// FIR filter followed by keeping every decimation-th output, computed in
+// polyphase form: the taps are split into `decimation` branches and every
+// input sample only runs through its own branch, so only the retained
+// outputs are ever computed (taps / decimation multiplies per input).
+// Output m equals the full rate filter output at input m * decimation.
+class Decimating_FIR_Filter final : public Filter {
+private:
+    FirWindow window;
+    int decimation;
+    int branch_length;          // taps per polyphase branch
+    std::shared_ptr<const FilterCoefficients> coefficients;    // shared by all channels with this design
+    std::shared_ptr<const std::vector<double>> branches;      // [branch][branch_length] taps, oldest input first, zero padded
+    std::vector<double> delay;  // [branch][2 * branch_length] past inputs of each branch, stored twice
+    int head;                   // delay slot of the current output period
+    int phase;                  // branch of the next input, counts down to 0
+    double accumulator;
+    double output;
+    bool new_output;
+    void calculateCoefficients() override;
+    double push(double data_in);
+
+public:
+    // order is the number of taps of the anti-aliasing filter
+    Decimating_FIR_Filter(int order, double sampling_rate, BandType band, double low_cut_off, double high_cut_off,
+                          int decimation, FirWindow window = FirWindow::hamming);
+
+    // Feeds one input sample and returns the newest decimated output, which
+    // is held until the next one is complete.
+    double calculateOutput(double data_in) override;
+
+    // Feeds n_samples inputs (`stride` values apart) without a virtual call per
+    // sample, writes the completed outputs `out_stride` values apart and
+    // returns their number.
+    template <typename T>
+    int processBlock(const T *in, int n_samples, int stride, T *out, int out_stride);
+
+    // true if the last calculateOutput call completed a decimated output
+    [[nodiscard]] bool hasNewOutput() const { return new_output; }
+    [[nodiscard]] double getOutput() const { return output; }
+
+    [[nodiscard]] int getDecimation() const { return decimation; }
+    [[nodiscard]] const aligned_vector<double> &getCoefficients() const { return coefficients->taps; }
+};
+
+#endif //DECIMATING_FIR_FILTER_H
@@ -7,20 +7,23 @@
 
 #include <vector>
 #include "Filter.h"
+#include "filter_coefficients.h"
 
 class FIR_Filter : public Filter {
 private:
-    std::vector<double> coefficients;
+    FirWindow window;
+    std::shared_ptr<const FilterCoefficients> coefficients;    // shared by all channels with this design
     std::vector<double> taps;
     int input_index;
     void calculateCoefficients() override;
 
 public:
-    FIR_Filter(int order, double sampling_rate, std::string data_type, std::string filter_type, double low_cut_off, double high_cut_off);
+    FIR_Filter(int order, double sampling_rate, BandType band, double low_cut_off, double high_cut_off,
+               FirWindow window = FirWindow::hamming);
 
     double calculateOutput(double data_in) override;
 
-    std::vector<double> getCoefficients();
+    [[nodiscard]] const aligned_vector<double> &getCoefficients() const { return coefficients->taps; }
 };
 
 
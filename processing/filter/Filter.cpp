@@ -1,12 +1,11 @@
 #include "Filter.h"
 #include <iostream>
-#include <utility>
 
 // Constructor
-Filter::Filter(const int order, const double sampling_rate, std::string  data_type,
-            std::string  filter_type, const double low_cut_off, const double high_cut_off)
-    : order(order), sampling_rate(sampling_rate), data_type(std::move(data_type)),
-    filter_type(std::move(filter_type)), low_cut_off(low_cut_off), high_cut_off(high_cut_off) {}
+Filter::Filter(const int order, const double sampling_rate, const BandType band,
+            const double low_cut_off, const double high_cut_off)
+    : order(order), sampling_rate(sampling_rate), band(band),
+    low_cut_off(low_cut_off), high_cut_off(high_cut_off) {}
 
 // Getter and Setter methods
 int Filter::getOrder() const {
@@ -25,12 +24,8 @@ double Filter::getLowCutOff() const {
     return low_cut_off;
 }
 
-std::string Filter::getDataType() const {
-    return data_type;
-}
-
-std::string Filter::getFilterType() const {
-    return filter_type;
+BandType Filter::getBandType() const {
+    return band;
 }
 
 // Method implementations
@@ -1,28 +1,25 @@
 #ifndef FILTER_H
 #define FILTER_H
 
-#include <string>
+#include "filter_design.h"
 
 class Filter {
 private:
     int order;
     double sampling_rate;
-    std::string data_type;
-    std::string filter_type;
+    BandType band;
     double low_cut_off;
     double high_cut_off;
 
 
 public:
-    Filter(int order, double sampling_rate, std::string  data_type, std::string filter_type, double low_cut_off, double high_cut_off);
+    Filter(int order, double sampling_rate, BandType band, double low_cut_off, double high_cut_off);
 
     [[nodiscard]] int getOrder() const;
 
     [[nodiscard]] double getSamplingRate() const;
 
-    [[nodiscard]] std::string getDataType() const;
-
-    [[nodiscard]] std::string getFilterType() const;
+    [[nodiscard]] BandType getBandType() const;
 
     [[nodiscard]] double getHighCutOff() const;
 
@@ -0,0 +1,190 @@
+#include "FirBank.h"
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include "../../lib/simd.h"
+
+FirMode parseFirMode(const std::string &name) {
+    if (name == "auto") return FirMode::automatic;
+    if (name == "direct") return FirMode::direct;
+    if (name == "fft") return FirMode::fft;
+    throw std::invalid_argument("Unsupported FIR mode: " + name);
+}
+
+template <typename T>
+FirBank<T>::FirBank(int n_channel, std::shared_ptr<const FilterCoefficients> coefficients, int block_size, FirMode mode)
+    : n_channel(n_channel), n_padded(simd::padded<T>(n_channel)),
+      n_taps(static_cast<int>(coefficients->taps.size())), coefficients(std::move(coefficients)),
+      direct_block(std::max(block_size, 1)), direct_kernel(selectFirKernel<T>(n_taps)),
+      block(static_cast<int>(std::bit_ceil(static_cast<unsigned>(std::max(block_size, 1))))),
+      n_partitions((n_taps + block - 1) / block), n_pairs((n_channel + 1) / 2), fft(2 * block) {
+    if (n_taps == 0) throw std::invalid_argument("FirBank needs FIR taps");
+    computePartitions();
+    spectrum.resize(2 * block);
+    selectEngine(mode);
+}
+
+template <typename T>
+void FirBank<T>::setTaps(std::shared_ptr<const FilterCoefficients> new_coefficients) {
+    if (static_cast<int>(new_coefficients->taps.size()) != n_taps) {
+        throw std::invalid_argument("FirBank::setTaps needs " + std::to_string(n_taps) + " taps, not " +
+                                    std::to_string(new_coefficients->taps.size()));
+    }
+    coefficients = std::move(new_coefficients);
+    computePartitions();
+}
+
+template <typename T>
+void FirBank<T>::computePartitions() {
+    const auto &h = coefficients->taps;
+    taps.assign(h.begin(), h.end());
+
+    // partition spectra, with the inverse FFT scaling folded in
+    const int n_fft = 2 * block;
+    partitions.assign(static_cast<size_t>(n_partitions) * n_fft, Complex(0));
+    for (int p = 0; p < n_partitions; p++) {
+        Complex *spectrum_p = &partitions[static_cast<size_t>(p) * n_fft];
+        for (int k = 0; k < block and p * block + k < n_taps; k++) {
+            spectrum_p[k] = Complex(static_cast<T>(h[p * block + k] / n_fft));
+        }
+        fft.forward(spectrum_p);
+    }
+}
+
+template <typename T>
+void FirBank<T>::reset() {
+    const size_t n_fft = 2 * block;
+    fill = 0;
+    newest = 0;
+    if (use_fft) {
+        history.clear();
+        delay_line.assign(static_cast<size_t>(n_pairs) * n_partitions * n_fft, Complex(0));
+        input.assign(static_cast<size_t>(n_pairs) * n_fft, Complex(0));
+    } else {
+        delay_line.clear();
+        input.clear();
+        history.assign(static_cast<size_t>(n_taps - 1 + direct_block) * n_padded, 0);
+    }
+}
+
+template <typename T>
+void FirBank<T>::selectEngine(FirMode mode) {
+    if (mode != FirMode::automatic) {
+        use_fft = mode == FirMode::fft;
+        reset();
+        return;
+    }
+
+    // measured crossover: time a few blocks of silence with each engine
+    std::vector<T> in(static_cast<size_t>(direct_block) * n_channel, 0), out(in.size());
+    auto measure = [&](bool fft_engine) {
+        use_fft = fft_engine;
+        reset();
+        double best = 1e300;
+        for (int rep = 0; rep < 8; rep++) {
+            const auto start = std::chrono::steady_clock::now();
+            processChunk(in.data(), out.data(), direct_block, n_channel);
+            best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+        }
+        return best;
+    };
+    const double direct_time = measure(false);
+    const double fft_time = measure(true);
+    use_fft = fft_time < direct_time;
+    reset();
+    std::cout << "FIR bank: " << n_taps << " taps, " << n_channel << " channels, direct " << direct_time * 1e6
+              << "us vs fft " << fft_time * 1e6 << "us per block of " << direct_block << " -> "
+              << (use_fft ? "fft" : "direct") << std::endl;
+}
+
+template <typename T>
+void FirBank<T>::processChunk(const T *in, T *out, int n_samples, int stride) {
+    if (use_fft) processFft(in, out, n_samples, stride);
+    else processDirect(in, out, n_samples, stride);
+}
+
+template <typename T>
+void FirBank<T>::processDirect(const T *in, T *out, int n_samples, int stride) {
+    const int n_keep = n_taps - 1;
+
+    for (int first = 0; first < n_samples; first += direct_block) {
+        const int n = std::min(direct_block, n_samples - first);
+        for (int s = 0; s < n; s++) {
+            std::memcpy(&history[static_cast<size_t>(n_keep + s) * n_padded], in + (first + s) * stride, n_channel * sizeof(T));
+        }
+
+        direct_kernel({taps.data(), n_taps, history.data(), n_channel, n_padded}, out + first * stride, n, stride);
+
+        // keep the last taps-1 frames for the next slice
+        std::memmove(history.data(), &history[static_cast<size_t>(n) * n_padded], static_cast<size_t>(n_keep) * n_padded * sizeof(T));
+    }
+}
+
+template <typename T>
+void FirBank<T>::processFft(const T *in, T *out, int n_samples, int stride) {
+    const int n_fft = 2 * block;
+    int first = 0;
+    while (first < n_samples) {
+        const int n = std::min(block - fill, n_samples - first);
+
+        for (int pair = 0; pair < n_pairs; pair++) {
+            const int ca = 2 * pair, cb = ca + 1;
+            const bool has_b = cb < n_channel;
+            Complex *x = &input[static_cast<size_t>(pair) * n_fft];
+
+            // second half of the FFT window is the current block, samples not seen yet are zero
+            for (int s = 0; s < n; s++) {
+                const T *frame = in + (first + s) * stride;
+                x[block + fill + s] = Complex(frame[ca], has_b ? frame[cb] : T(0));
+            }
+
+            // spectrum of the current block into the newest delay line slot
+            Complex *line = &delay_line[static_cast<size_t>(pair) * n_partitions * n_fft];
+            Complex *current = &line[static_cast<size_t>(newest) * n_fft];
+            std::copy_n(x, n_fft, current);
+            fft.forward(current);
+
+            // sum over partitions of input block spectrum (p blocks old) times tap partition p
+            std::fill(spectrum.begin(), spectrum.end(), Complex(0));
+            for (int p = 0; p < n_partitions; p++) {
+                int slot = newest - p;
+                if (slot < 0) slot += n_partitions;
+                const Complex *xp = &line[static_cast<size_t>(slot) * n_fft];
+                const Complex *hp = &partitions[static_cast<size_t>(p) * n_fft];
+                for (int k = 0; k < n_fft; k++) {
+                    const T re = xp[k].real() * hp[k].real() - xp[k].imag() * hp[k].imag();
+                    const T im = xp[k].real() * hp[k].imag() + xp[k].imag() * hp[k].real();
+                    spectrum[k] = {spectrum[k].real() + re, spectrum[k].imag() + im};
+                }
+            }
+            fft.inverse(spectrum.data());
+
+            // the second half holds the linear convolution of the current block
+            for (int s = 0; s < n; s++) {
+                T *frame = out + (first + s) * stride;
+                frame[ca] = spectrum[block + fill + s].real();
+                if (has_b) frame[cb] = spectrum[block + fill + s].imag();
+            }
+        }
+
+        fill += n;
+        first += n;
+        if (fill == block) {
+            // the current block becomes the previous one
+            for (int pair = 0; pair < n_pairs; pair++) {
+                Complex *x = &input[static_cast<size_t>(pair) * n_fft];
+                std::copy_n(x + block, block, x);
+                std::fill_n(x + block, block, Complex(0));
+            }
+            newest = (newest + 1) % n_partitions;
+            fill = 0;
+        }
+    }
+}
+
+template class FirBank<float>;
+template class FirBank<double>;
@@ -0,0 +1,83 @@
+#ifndef FIR_BANK_H
+#define FIR_BANK_H
+
+#include <complex>
+#include <memory>
+#include <string>
+#include <vector>
+#include "../../lib/aligned_allocator.h"
+#include "fft.h"
+#include "filter_coefficients.h"
+#include "filter_kernels.h"
+
+enum class FirMode { automatic, direct, fft };
+FirMode parseFirMode(const std::string &name);
+
+// Bank of one FIR filter per channel, all channels share the taps. Two
+// engines compute the same causal convolution:
+//  - direct: time-major history of the last taps-1 samples, taps broadcast
+//    and simd::Vec<T>::width channels per instruction, O(taps) per sample.
+//  - fft: uniformly partitioned overlap-save. The taps are split into
+//    partitions of block_size, each transformed once (2 * block_size FFT);
+//    every input block is transformed once, kept in a frequency domain delay
+//    line and multiplied with all partition spectra, so the cost per sample
+//    grows with log(block_size) + taps / block_size. Two channels share one
+//    complex FFT (real and imaginary part), which is exact because the taps
+//    are real. Chunks that end inside a block are computed with the missing
+//    samples as zeros, so there is no added latency for any chunk size.
+// With FirMode::automatic both engines are timed on a block of this bank's
+// shape and the faster one is used.
+template <typename T>
+class FirBank {
+public:
+    FirBank(int n_channel, std::shared_ptr<const FilterCoefficients> coefficients, int block_size, FirMode mode);
+
+    // Filters n_samples time steps. in/out point to the first channel of the
+    // first sample, consecutive samples are `stride` values apart.
+    void processChunk(const T *in, T *out, int n_samples, int stride);
+
+    // Replaces the taps with those of a design of the same length. Both
+    // engines keep their input history (the direct delay line, the fft input
+    // spectra), so the output continues without a transient and the engine
+    // is not timed again.
+    void setTaps(std::shared_ptr<const FilterCoefficients> coefficients);
+
+    [[nodiscard]] bool usesFft() const { return use_fft; }
+    [[nodiscard]] int getTapCount() const { return n_taps; }
+    [[nodiscard]] int getChannelCount() const { return n_channel; }
+
+private:
+    using Complex = std::complex<T>;
+
+    int n_channel;
+    int n_padded;
+    int n_taps;
+    bool use_fft = false;
+    std::shared_ptr<const FilterCoefficients> coefficients;
+    aligned_vector<T> taps;
+
+    // direct engine
+    int direct_block;
+    aligned_vector<T> history;          // [(n_taps - 1 + direct_block) frames][n_padded]
+    FirKernelFn<T> direct_kernel;       // specialised for n_taps
+
+    // fft engine
+    int block;                          // partition and block length, power of two
+    int n_partitions;
+    int n_pairs;
+    Fft<T> fft;
+    std::vector<Complex> partitions;    // [partition][2 * block] tap spectra, scaled by 1 / (2 * block)
+    std::vector<Complex> delay_line;    // [pair][partition][2 * block] input block spectra
+    std::vector<Complex> input;         // [pair][2 * block] previous and current input block
+    std::vector<Complex> spectrum;      // 2 * block scratch
+    int fill = 0;                       // samples of the current block seen so far
+    int newest = 0;                     // delay line slot of the current block
+
+    void processDirect(const T *in, T *out, int n_samples, int stride);
+    void processFft(const T *in, T *out, int n_samples, int stride);
+    void computePartitions();
+    void selectEngine(FirMode mode);
+    void reset();
+};
+
+#endif //FIR_BANK_H
@@ -0,0 +1,175 @@
+#include "FixedBiquadBank.h"
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include "../../lib/simd.h"
+
+// peak magnitude of the first n_sections of the cascade, on a grid from 0 to Nyquist
+static double peakGain(const SosCascade &cascade, size_t n_sections) {
+    constexpr int n_points = 1024;
+    double peak = 0.0;
+    for (int i = 0; i <= n_points; i++) {
+        const std::complex<double> z1 = std::polar(1.0, -M_PI * i / n_points);
+        const std::complex<double> z2 = z1 * z1;
+        std::complex<double> h = 1.0;
+        for (size_t section = 0; section < n_sections; section++) {
+            const SosSection &s = cascade[section];
+            h *= (s.b0 + s.b1 * z1 + s.b2 * z2) / (1.0 + s.a1 * z1 + s.a2 * z2);
+        }
+        peak = std::max(peak, std::abs(h));
+    }
+    return peak;
+}
+
+FixedBiquadBank::FixedBiquadBank(int n_channel, int fraction_bits)
+    : n_channel(n_channel), n_padded(simd::padded<int32_t>(n_channel)), n_sections(0), fraction_bits(fraction_bits) {
+    if (fraction_bits < accumulator_bits or fraction_bits > 14) {
+        throw std::invalid_argument("Fixed-point fraction bits must be between " + std::to_string(accumulator_bits) + " and 14");
+    }
+    setSections(SosCascade{{1, 0, 0, 0, 0}});
+}
+
+void FixedBiquadBank::setSections(const SosCascade &cascade) {
+    if (cascade.empty()) throw std::invalid_argument("FixedBiquadBank needs at least one section");
+
+    // section k is scaled by g(k-1) / g(k), g(k) = peak gain of sections 0..k,
+    // the last one by g(n-2) so that the total gain is unchanged
+    SosCascade scaled = cascade;
+    double previous_peak = 1.0;
+    for (size_t section = 0; section < scaled.size(); section++) {
+        const bool last = section + 1 == scaled.size();
+        const double peak = last ? 1.0 : peakGain(cascade, section + 1);
+        if (peak <= 0.0) throw std::invalid_argument("Cannot scale a cascade with zero gain for fixed-point arithmetic");
+        const double scale = previous_peak / peak;
+        scaled[section].b0 *= scale;
+        scaled[section].b1 *= scale;
+        scaled[section].b2 *= scale;
+        previous_peak = peak;
+    }
+
+    auto quantise = [](double coefficient, int bits) { return std::lround(std::ldexp(coefficient, bits)); };
+    auto fits = [](long value) { return value >= std::numeric_limits<int16_t>::min() and value <= std::numeric_limits<int16_t>::max(); };
+    auto format = [](int bits) { return "Q" + std::to_string(15 - bits) + "." + std::to_string(bits); };
+
+    const size_t count = scaled.size();
+    std::vector<int32_t> qb0(count), qb1(count), qb2(count), qa1(count), qa2(count);
+    std::vector<int> shifts(count);
+    for (size_t section = 0; section < count; section++) {
+        const SosSection &s = scaled[section];
+        // |a2| < 1 (stable) and f <= 14 keep a2 * y below 2^29
+        if (std::abs(s.a2) >= 1.0) throw std::invalid_argument("Unstable section, |a2| = " + std::to_string(std::abs(s.a2)));
+        const long a1 = quantise(s.a1, fraction_bits), a2 = quantise(s.a2, fraction_bits);
+        if (not fits(a1)) throw std::invalid_argument("Filter coefficient " + std::to_string(s.a1) + " does not fit " + format(fraction_bits));
+
+        // b1 is derived from b0 and b2 where the zeros sit at DC / Nyquist
+        // (high- and lowpass halves of band designs): a leak there would be
+        // amplified by the poles close to z = 1
+        const double b_max = std::max({std::abs(s.b0), std::abs(s.b1), std::abs(s.b2)});
+        const bool dc_zero = std::abs(s.b0 + s.b1 + s.b2) <= 1e-9 * b_max;
+        const bool nyquist_zero = std::abs(s.b0 - s.b1 + s.b2) <= 1e-9 * b_max;
+        auto numerator = [&](int bits, long &q0, long &q1, long &q2) {
+            q0 = quantise(s.b0, bits);
+            q2 = quantise(s.b2, bits);
+            q1 = dc_zero ? -(q0 + q2) : nyquist_zero ? q0 + q2 : quantise(s.b1, bits);
+            // |b0| + |b1| + |b2| < 2^16 keeps the b * x sums of int16 inputs below 2^31
+            return fits(q0) and fits(q1) and fits(q2) and std::abs(q0) + std::abs(q1) + std::abs(q2) < 65536;
+        };
+        // as many numerator fraction bits as the coefficients leave room for;
+        // at least A + 1, which limits the numerator to |b0| + |b1| + |b2| < 32
+        long b0 = 0, b1 = 0, b2 = 0;
+        int bits = b_max > 0.0 ? 30 : accumulator_bits + 1;
+        while (not numerator(bits, b0, b1, b2)) {
+            if (--bits <= accumulator_bits) {
+                throw std::invalid_argument("Numerator of section " + std::to_string(section) + " too large for fixed point: " +
+                                            std::to_string(s.b0) + " " + std::to_string(s.b1) + " " + std::to_string(s.b2));
+            }
+        }
+        const int shift = bits - accumulator_bits;
+        qb0[section] = static_cast<int32_t>(b0);
+        qb1[section] = static_cast<int32_t>(b1);
+        qb2[section] = static_cast<int32_t>(b2);
+        qa1[section] = static_cast<int32_t>(a1);
+        qa2[section] = static_cast<int32_t>(a2);
+        shifts[section] = shift;
+    }
+
+    if (static_cast<int>(count) != n_sections) {
+        n_sections = static_cast<int>(count);
+        for (auto *z : {&zb1, &zb2, &za1, &za2}) z->assign(static_cast<size_t>(n_sections) * n_padded, 0);
+    }
+    b0 = std::move(qb0);
+    b1 = std::move(qb1);
+    b2 = std::move(qb2);
+    a1 = std::move(qa1);
+    a2 = std::move(qa2);
+    b_shift = std::move(shifts);
+}
+
+void FixedBiquadBank::processChunk(const int16_t *in, int16_t *out, int n_samples, int stride) {
+    using V = simd::Vec<int32_t>;
+    constexpr int32_t y_min = std::numeric_limits<int16_t>::min(), y_max = std::numeric_limits<int16_t>::max();
+    constexpr int shift = accumulator_bits;
+    const int a_shift = fraction_bits - accumulator_bits;
+    constexpr int32_t half = 1 << (shift - 1);
+    constexpr int32_t one = 1 << shift;
+    const V vhalf = V::broadcast(half), vone = V::broadcast(one), vminus_one = V::broadcast(-one);
+    const V vmin = V::broadcast(y_min), vmax = V::broadcast(y_max);
+
+    // one section at a time over the whole chunk, later sections filter the
+    // output in place while it is still in L1
+    for (int section = 0; section < n_sections; section++) {
+        const int16_t *src = section == 0 ? in : out;
+        const int32_t cb0 = b0[section], cb1 = b1[section], cb2 = b2[section];
+        const int32_t ca1 = a1[section], ca2 = a2[section];
+        const V vb0 = V::broadcast(cb0), vb1 = V::broadcast(cb1), vb2 = V::broadcast(cb2);
+        const V va1 = V::broadcast(ca1), va2 = V::broadcast(ca2);
+        const int b_bits = b_shift[section];
+        const size_t offset = static_cast<size_t>(section) * n_padded;
+        int c = 0;
+
+        // full vectors: state of the channel block in registers for the whole chunk
+        for (; c + V::width <= n_channel; c += V::width) {
+            const size_t i = offset + c;
+            V sb1 = V::load(&zb1[i]), sb2 = V::load(&zb2[i]), sa1 = V::load(&za1[i]), sa2 = V::load(&za2[i]);
+            for (int s = 0; s < n_samples; s++) {
+                const V x = V::load16(src + s * stride + c);
+                const V acc = ((vb0 * x + sb1) >> b_bits) + (sa1 >> a_shift);
+                const V y = min(max((acc + vhalf) >> shift, vmin), vmax);
+                const V r = min(max(acc - (y << shift), vminus_one), vone);
+                sb1 = vb1 * x + sb2;
+                sb2 = vb2 * x;
+                sa1 = sa2 - va1 * y - ((va1 * r) >> shift);
+                sa2 = V::zero() - va2 * y - ((va2 * r) >> shift);
+                y.store16(out + s * stride + c);
+            }
+            sb1.store(&zb1[i]);
+            sb2.store(&zb2[i]);
+            sa1.store(&za1[i]);
+            sa2.store(&za2[i]);
+        }
+
+        // remaining channels
+        for (; c < n_channel; c++) {
+            const size_t i = offset + c;
+            int32_t sb1 = zb1[i], sb2 = zb2[i], sa1 = za1[i], sa2 = za2[i];
+            for (int s = 0; s < n_samples; s++) {
+                const int32_t x = src[s * stride + c];
+                const int32_t acc = ((cb0 * x + sb1) >> b_bits) + (sa1 >> a_shift);
+                const int32_t y = std::clamp((acc + half) >> shift, y_min, y_max);
+                const int32_t r = std::clamp(acc - (y << shift), -one, one);
+                sb1 = cb1 * x + sb2;
+                sb2 = cb2 * x;
+                sa1 = sa2 - ca1 * y - ((ca1 * r) >> shift);
+                sa2 = -ca2 * y - ((ca2 * r) >> shift);
+                out[s * stride + c] = static_cast<int16_t>(y);
+            }
+            zb1[i] = sb1;
+            zb2[i] = sb2;
+            za1[i] = sa1;
+            za2[i] = sa2;
+        }
+    }
+}
@@ -0,0 +1,63 @@
+#ifndef FIXED_BIQUAD_BANK_H
+#define FIXED_BIQUAD_BANK_H
+
+#include <cstdint>
+#include <vector>
+#include "../../lib/aligned_allocator.h"
+#include "sos.h"
+
+// Fixed-point counterpart of BiquadBank with the arithmetic of a hardware
+// front end: int16 samples in and out, int16 coefficients, int32 state and
+// accumulators, saturating int16 outputs. The denominator is in Q(15 - f).f
+// (f = fraction_bits), each section's numerator gets as many fraction bits n
+// as its coefficients leave room for (normalised band designs have numerators
+// far below one that f bits would resolve to a few percent). The accumulator
+// has A = accumulator_bits fraction bits below the output LSB. A section in
+// transposed direct form II keeps the numerator (Q .n) and denominator (Q .f)
+// terms apart:
+//   acc = floor((b0 * x + zb1) / 2^(n-A)) + floor(za1 / 2^(f-A))     Q .A
+//   y   = sat16(round(acc / 2^A))          r = acc - y * 2^A
+//   zb1 = b1 * x + zb2                     zb2 = b2 * x
+//   za1 = za2 - a1 * y - floor(a1 * r / 2^A)
+//   za2 = -a2 * y - floor(a2 * r / 2^A)
+// Feeding the rounding residual r back keeps the A fraction bits of the
+// output in the recursion (poles close to z = 1 would amplify the rounding
+// error a hundredfold otherwise), only the section outputs are int16. The
+// coefficient ranges (|a2| < 1, |b0| + |b1| + |b2| < 32) bound every sum below
+// 2^31 for any int16 input, so nothing but the outputs can saturate and the
+// result is bit exact on any instruction set.
+//
+// Designs put the whole gain of the cascade into the first section, whose
+// int16 output would then lose most of its resolution. The numerators are
+// rescaled so that each partial cascade has unit peak gain (the overall gain
+// stays the same), which also bounds every intermediate signal by the input.
+class FixedBiquadBank {
+public:
+    static constexpr int accumulator_bits = 10;
+
+    // fraction_bits between accumulator_bits and 14
+    explicit FixedBiquadBank(int n_channel, int fraction_bits = 14);
+
+    // quantises the cascade, throws if a coefficient does not fit its format.
+    // Changing the number of sections resets the filter state.
+    void setSections(const SosCascade &cascade);
+
+    // Filters n_samples time steps. in/out point to the first channel of the
+    // first sample, consecutive samples are `stride` values apart.
+    void processChunk(const int16_t *in, int16_t *out, int n_samples, int stride);
+
+    [[nodiscard]] int getChannelCount() const { return n_channel; }
+    [[nodiscard]] int getSectionCount() const { return n_sections; }
+    [[nodiscard]] int getFractionBits() const { return fraction_bits; }
+
+private:
+    int n_channel;
+    int n_padded;
+    int n_sections;
+    int fraction_bits;
+    std::vector<int32_t> b0, b1, b2, a1, a2;    // [section] int16 values
+    std::vector<int> b_shift;                   // [section] numerator fraction bits n - A
+    aligned_vector<int32_t> zb1, zb2, za1, za2; // [section * n_padded + channel]
+};
+
+#endif //FIXED_BIQUAD_BANK_H
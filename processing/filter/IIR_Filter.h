@@ -2,26 +2,32 @@
 #define IIR_FILTER_H
 
 #include "Filter.h"
+#include "filter_coefficients.h"
+#include <memory>
 #include <vector>
 
 class IIR_Filter : public Filter {
 public:
-    IIR_Filter(int order, double sampling_rate, std::string data_type, std::string filter_type, double low_cut_off, double high_cut_off);
+    // ripple: chebyshev1 passband ripple in dB, attenuation: chebyshev2 stopband attenuation in dB
+    IIR_Filter(int order, double sampling_rate, BandType band, double low_cut_off, double high_cut_off,
+               IirFamily family = IirFamily::butterworth, double ripple = 1.0, double attenuation = 40.0);
 
     // Calculates the output for the given input
     double calculateOutput(double data_in) override;
 
-    // Returns the filter coefficients
+    // Returns the filter coefficients as second order sections
+    [[nodiscard]] const SosCascade &getSections() const { return coefficients->sections; }
+
+    // Returns the expanded transfer function coefficients (b and a)
     std::vector<double> getNumeratorCoefficients();
     std::vector<double> getDenominatorCoefficients();
 
 private:
-    std::vector<double> numerator;     // b coefficients
-    std::vector<double> denominator;  // a coefficients
-    std::vector<double> taps;          // Past inputs
-    std::vector<double> out_taps;   // Past outputs
-    int input_index;                 // Index for input ring buffer
-    int output_index;
+    IirFamily family;
+    double ripple;
+    double attenuation;
+    std::shared_ptr<const FilterCoefficients> coefficients;    // shared by all channels with this design
+    std::vector<double> state;      // z1, z2 of every section
     void calculateCoefficients() override; // Calculate filter coefficients
 };
 
@@ -0,0 +1,50 @@
+#include "fft.h"
+#include <bit>
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+
+template <typename T>
+Fft<T>::Fft(int size) : size(size), bit_reverse(size), twiddles(size / 2), inverse_twiddles(size / 2) {
+    if (size < 1 or !std::has_single_bit(static_cast<unsigned>(size))) {
+        throw std::invalid_argument("FFT size must be a power of two");
+    }
+    const int bits = std::countr_zero(static_cast<unsigned>(size));
+    for (int i = 0; i < size; i++) {
+        int r = 0;
+        for (int b = 0; b < bits; b++) r |= ((i >> b) & 1) << (bits - 1 - b);
+        bit_reverse[i] = r;
+    }
+    for (int k = 0; k < size / 2; k++) {
+        const double phase = -2 * M_PI * k / size;
+        twiddles[k] = {static_cast<T>(std::cos(phase)), static_cast<T>(std::sin(phase))};
+        inverse_twiddles[k] = std::conj(twiddles[k]);
+    }
+}
+
+template <typename T>
+void Fft<T>::transform(std::complex<T> *data, const std::complex<T> *w) const {
+    for (int i = 0; i < size; i++) {
+        if (i < bit_reverse[i]) std::swap(data[i], data[bit_reverse[i]]);
+    }
+    // butterflies written out on real and imaginary parts, std::complex
+    // multiplication would add NaN/Inf recovery to every product
+    for (int len = 2; len <= size; len <<= 1) {
+        const int half = len / 2;
+        const int step = size / len;
+        for (int start = 0; start < size; start += len) {
+            for (int k = 0; k < half; k++) {
+                const std::complex<T> tw = w[k * step];
+                std::complex<T> &a = data[start + k];
+                std::complex<T> &b = data[start + k + half];
+                const T re = b.real() * tw.real() - b.imag() * tw.imag();
+                const T im = b.real() * tw.imag() + b.imag() * tw.real();
+                b = {a.real() - re, a.imag() - im};
+                a = {a.real() + re, a.imag() + im};
+            }
+        }
+    }
+}
+
+template class Fft<float>;
+template class Fft<double>;
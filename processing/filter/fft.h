@@ -0,0 +1,29 @@
+#ifndef FFT_H
+#define FFT_H
+
+#include <complex>
+#include <vector>
+
+// In-place iterative radix-2 complex FFT of a fixed power-of-two size with
+// precomputed bit reversal and twiddle tables. The inverse is unscaled
+// (callers fold the 1/size factor into their filter spectra).
+template <typename T>
+class Fft {
+public:
+    explicit Fft(int size);
+
+    void forward(std::complex<T> *data) const { transform(data, twiddles.data()); }
+    void inverse(std::complex<T> *data) const { transform(data, inverse_twiddles.data()); }
+
+    [[nodiscard]] int getSize() const { return size; }
+
+private:
+    int size;
+    std::vector<int> bit_reverse;
+    std::vector<std::complex<T>> twiddles;            // exp(-2 pi i k / size), k < size / 2
+    std::vector<std::complex<T>> inverse_twiddles;    // conjugates
+
+    void transform(std::complex<T> *data, const std::complex<T> *w) const;
+};
+
+#endif //FFT_H
@@ -0,0 +1,63 @@
+#include "filter_coefficients.h"
+#include "Biquad.h"
+#include <map>
+#include <mutex>
+
+FilterDesign FilterDesign::fromConfig(const FilterConfig &filter, double sampling_rate) {
+    return {parseFilterClass(filter.filter_class), filter.order, parseBandType(filter.type), filter.lowcut, filter.highcut,
+            sampling_rate, parseIirFamily(filter.design), filter.ripple, filter.attenuation, parseFirWindow(filter.window),
+            filter.notch, filter.notch_harmonics, filter.notch_q};
+}
+
+static std::shared_ptr<const FilterCoefficients> design(const FilterDesign &d) {
+    auto coefficients = std::make_shared<FilterCoefficients>();
+    // single edge designs use the low cut off for lowpass and the high cut off for highpass filters
+    const double f1 = (d.band == BandType::highpass) ? d.high_cut_off : d.low_cut_off;
+    if (d.filter_class == FilterClass::iir) {
+        coefficients->sections = designIir(d.family, d.order, d.band, f1, d.high_cut_off,
+                                           d.sampling_rate, d.ripple, d.attenuation);
+    } else if (d.filter_class == FilterClass::biquad) {
+        double b0, b1, b2, a1, a2;
+        Biquad(bq_type_bandpass, ((d.high_cut_off + d.low_cut_off) / 2) / d.sampling_rate, 0.707, 0)
+            .getCoefficients(b0, b1, b2, a1, a2);
+        coefficients->sections = {{b0, b1, b2, a1, a2}};
+    } else {
+        const std::vector<double> taps = designFir(d.order, d.band, f1, d.high_cut_off, d.sampling_rate, d.window);
+        coefficients->taps.assign(taps.begin(), taps.end());
+    }
+    // notches run as extra sections of the same cascade, in the same pass over the samples
+    if (d.notch_frequency > 0) {
+        const SosCascade notches = designNotches(d.notch_frequency, d.notch_harmonics, d.notch_q, d.sampling_rate);
+        coefficients->sections.insert(coefficients->sections.end(), notches.begin(), notches.end());
+        coefficients->n_notches = static_cast<int>(notches.size());
+    }
+    return coefficients;
+}
+
+std::shared_ptr<const FilterCoefficients> getFilterCoefficients(const FilterDesign &d) {
+    static std::mutex mutex;
+    static std::map<FilterDesign, std::shared_ptr<const FilterCoefficients>> cache;
+
+    // parameters of the other filter class do not change the design
+    FilterDesign key = d;
+    if (key.filter_class != FilterClass::fir) {
+        key.window = FirWindow::hamming;
+    }
+    if (key.filter_class != FilterClass::iir) {
+        key.family = IirFamily::butterworth;
+        key.ripple = key.attenuation = 0;
+    }
+    if (key.filter_class == FilterClass::biquad) {
+        key.order = 0;
+        key.band = BandType::bandpass;
+    }
+    if (key.notch_frequency <= 0) {
+        key.notch_frequency = key.notch_q = 0;
+        key.notch_harmonics = 0;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = cache.find(key);
+    if (it == cache.end()) it = cache.emplace(key, design(key)).first;
+    return it->second;
+}
@@ -0,0 +1,45 @@
+#ifndef FILTER_COEFFICIENTS_H
+#define FILTER_COEFFICIENTS_H
+
+#include <compare>
+#include <memory>
+#include "../../lib/aligned_allocator.h"
+#include "../../lib/config.h"
+#include "filter_design.h"
+#include "sos.h"
+
+// Everything a filter design depends on, used as key of the design cache.
+struct FilterDesign {
+    FilterClass filter_class;
+    int order;                  // IIR order or number of FIR taps
+    BandType band;
+    double low_cut_off;
+    double high_cut_off;
+    double sampling_rate;
+    IirFamily family;
+    double ripple;
+    double attenuation;
+    FirWindow window;
+    double notch_frequency = 0;     // line frequency, 0 for no notches
+    int notch_harmonics = 0;
+    double notch_q = 0;
+
+    // parses the names of the config, throws std::invalid_argument for unknown ones
+    static FilterDesign fromConfig(const FilterConfig &filter, double sampling_rate);
+    auto operator<=>(const FilterDesign &) const = default;
+};
+
+// Designed coefficients, immutable and cache line aligned. One instance is
+// shared by every channel (and every filter object) with the same design,
+// only the filter state is per channel.
+struct FilterCoefficients {
+    SosCascade sections;            // IIR designs, followed by the notch sections
+    aligned_vector<double> taps;    // FIR designs
+    int n_notches = 0;              // notch sections, the last ones of `sections` (all of them for FIR designs)
+};
+
+// Process-wide design cache: designs on first use, afterwards returns the
+// shared coefficients. Thread safe.
+std::shared_ptr<const FilterCoefficients> getFilterCoefficients(const FilterDesign &design);
+
+#endif //FILTER_COEFFICIENTS_H
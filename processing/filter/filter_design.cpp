@@ -0,0 +1,397 @@
+#include "filter_design.h"
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+
+using complex = std::complex<double>;
+using Roots = std::vector<complex>;
+
+// zeros, poles and gain of a transfer function
+struct Zpk {
+    Roots z;
+    Roots p;
+    double k;
+};
+
+// prod(s - r) over all roots r
+complex productShifted(const Roots &roots, complex s) {
+    complex product = 1.0;
+    for (const complex &r : roots) product *= s - r;
+    return product;
+}
+
+int relativeDegree(const Zpk &zpk) {
+    if (zpk.p.size() < zpk.z.size()) throw std::invalid_argument("filter design: improper transfer function");
+    return static_cast<int>(zpk.p.size() - zpk.z.size());
+}
+
+// normalised analog lowpass prototypes (scipy buttap, cheb1ap, cheb2ap)
+Zpk analogPrototype(IirFamily family, int n, double ripple_db, double attenuation_db) {
+    Zpk proto{{}, {}, 1.0};
+    switch (family) {
+        case IirFamily::butterworth:
+            for (int m = -n + 1; m < n; m += 2) proto.p.push_back(-std::exp(complex(0, M_PI * m / (2.0 * n))));
+            break;
+        case IirFamily::chebyshev1: {
+            const double eps = std::sqrt(std::pow(10.0, 0.1 * ripple_db) - 1.0);
+            const double mu = std::asinh(1.0 / eps) / n;
+            for (int m = -n + 1; m < n; m += 2) proto.p.push_back(-std::sinh(complex(mu, M_PI * m / (2.0 * n))));
+            proto.k = productShifted(proto.p, 0).real();
+            if (n % 2 == 0) proto.k /= std::sqrt(1.0 + eps * eps);
+            break;
+        }
+        case IirFamily::chebyshev2: {
+            const double de = 1.0 / std::sqrt(std::pow(10.0, 0.1 * attenuation_db) - 1.0);
+            const double mu = std::asinh(1.0 / de) / n;
+            for (int m = -n + 1; m < n; m += 2) {
+                if (m == 0) continue;   // odd orders have one zero at infinity
+                proto.z.push_back(-std::conj(complex(0, 1) / std::sin(m * M_PI / (2.0 * n))));
+            }
+            for (int m = -n + 1; m < n; m += 2) {
+                const complex p = -std::exp(complex(0, M_PI * m / (2.0 * n)));
+                proto.p.push_back(1.0 / complex(std::sinh(mu) * p.real(), std::cosh(mu) * p.imag()));
+            }
+            proto.k = (productShifted(proto.p, 0) / productShifted(proto.z, 0)).real();
+            break;
+        }
+    }
+    return proto;
+}
+
+void lowpassToLowpass(Zpk &zpk, double wo) {
+    const int degree = relativeDegree(zpk);
+    for (complex &z : zpk.z) z *= wo;
+    for (complex &p : zpk.p) p *= wo;
+    zpk.k *= std::pow(wo, degree);
+}
+
+void lowpassToHighpass(Zpk &zpk, double wo) {
+    const int degree = relativeDegree(zpk);
+    zpk.k *= (productShifted(zpk.z, 0) / productShifted(zpk.p, 0)).real();
+    for (complex &z : zpk.z) z = wo / z;
+    for (complex &p : zpk.p) p = wo / p;
+    zpk.z.insert(zpk.z.end(), degree, 0.0);
+}
+
+// every root r becomes the pair r +- sqrt(r^2 - wo^2)
+Roots splitRoots(const Roots &roots, double wo) {
+    Roots split;
+    for (const complex &r : roots) split.push_back(r + std::sqrt(r * r - wo * wo));
+    for (const complex &r : roots) split.push_back(r - std::sqrt(r * r - wo * wo));
+    return split;
+}
+
+void lowpassToBandpass(Zpk &zpk, double wo, double bw) {
+    const int degree = relativeDegree(zpk);
+    for (complex &z : zpk.z) z *= bw / 2;
+    for (complex &p : zpk.p) p *= bw / 2;
+    zpk.z = splitRoots(zpk.z, wo);
+    zpk.p = splitRoots(zpk.p, wo);
+    zpk.z.insert(zpk.z.end(), degree, 0.0);
+    zpk.k *= std::pow(bw, degree);
+}
+
+void lowpassToBandstop(Zpk &zpk, double wo, double bw) {
+    const int degree = relativeDegree(zpk);
+    zpk.k *= (productShifted(zpk.z, 0) / productShifted(zpk.p, 0)).real();
+    for (complex &z : zpk.z) z = (bw / 2) / z;
+    for (complex &p : zpk.p) p = (bw / 2) / p;
+    zpk.z = splitRoots(zpk.z, wo);
+    zpk.p = splitRoots(zpk.p, wo);
+    zpk.z.insert(zpk.z.end(), degree, complex(0, wo));
+    zpk.z.insert(zpk.z.end(), degree, complex(0, -wo));
+}
+
+// bilinear transform with fs2 = 2 * fs (scipy bilinear_zpk)
+void bilinear(Zpk &zpk, double fs) {
+    const int degree = relativeDegree(zpk);
+    const double fs2 = 2.0 * fs;
+    zpk.k *= (productShifted(zpk.z, fs2) / productShifted(zpk.p, fs2)).real();
+    for (complex &z : zpk.z) z = (fs2 + z) / (fs2 - z);
+    for (complex &p : zpk.p) p = (fs2 + p) / (fs2 - p);
+    zpk.z.insert(zpk.z.end(), degree, -1.0);
+}
+
+// Keeps one root of every complex conjugate pair (positive imaginary part,
+// averaged with its partner) followed by the real roots, whose imaginary
+// parts are set to exactly zero (scipy _cplxreal).
+Roots conjugatePairsThenReals(const Roots &roots) {
+    const double tol = 100 * std::numeric_limits<double>::epsilon();
+    std::vector<double> reals;
+    Roots positive, negative;
+    for (const complex &r : roots) {
+        if (std::abs(r.imag()) <= tol * std::abs(r)) reals.push_back(r.real());
+        else if (r.imag() > 0) positive.push_back(r);
+        else negative.push_back(r);
+    }
+    if (positive.size() != negative.size()) throw std::runtime_error("filter design: unpaired complex root");
+
+    auto by_real_then_imag = [](const complex &a, const complex &b) {
+        return a.real() < b.real() or (a.real() == b.real() and std::abs(a.imag()) < std::abs(b.imag()));
+    };
+    std::stable_sort(positive.begin(), positive.end(), by_real_then_imag);
+    std::stable_sort(reals.begin(), reals.end());
+
+    Roots result;
+    for (const complex &r : positive) {
+        auto partner = std::min_element(negative.begin(), negative.end(), [&r](const complex &a, const complex &b) {
+            return std::abs(a - std::conj(r)) < std::abs(b - std::conj(r));
+        });
+        if (std::abs(*partner - std::conj(r)) > tol * std::abs(*partner)) {
+            throw std::runtime_error("filter design: complex root without conjugate");
+        }
+        result.push_back((r + std::conj(*partner)) / 2.0);
+        negative.erase(partner);
+    }
+    for (double r : reals) result.emplace_back(r, 0.0);
+    return result;
+}
+
+bool isReal(const complex &r) { return r.imag() == 0.0; }
+
+long countReal(const Roots &roots) { return std::count_if(roots.begin(), roots.end(), isReal); }
+
+// the pole closest to the unit circle
+size_t worstPole(const Roots &poles, bool real_only = false) {
+    size_t worst = poles.size();
+    for (size_t i = 0; i < poles.size(); i++) {
+        if (real_only and !isReal(poles[i])) continue;
+        if (worst == poles.size() or std::abs(1 - std::abs(poles[i])) < std::abs(1 - std::abs(poles[worst]))) worst = i;
+    }
+    return worst;
+}
+
+enum class RootKind { any, real, complex };
+
+// removes and returns the root closest to `to` of the given kind
+complex takeNearest(Roots &roots, const complex &to, RootKind kind) {
+    size_t nearest = roots.size();
+    for (size_t i = 0; i < roots.size(); i++) {
+        if (kind == RootKind::real and !isReal(roots[i])) continue;
+        if (kind == RootKind::complex and isReal(roots[i])) continue;
+        if (nearest == roots.size() or std::abs(roots[i] - to) < std::abs(roots[nearest] - to)) nearest = i;
+    }
+    if (nearest == roots.size()) throw std::runtime_error("filter design: no zero left to pair");
+    const complex root = roots[nearest];
+    roots.erase(roots.begin() + static_cast<long>(nearest));
+    return root;
+}
+
+// second order section from up to two zeros and two poles (a polynomial with
+// fewer roots is right-aligned, i.e. delayed, like scipy's _single_zpksos)
+SosSection sectionFromRoots(const Roots &z, const Roots &p) {
+    auto poly = [](const Roots &roots) {
+        std::vector<double> c = {0, 0, 1};
+        if (roots.size() == 1) c = {0, 1, -roots[0].real()};
+        if (roots.size() == 2) c = {1, -(roots[0] + roots[1]).real(), (roots[0] * roots[1]).real()};
+        return c;
+    };
+    const std::vector<double> b = poly(z), a = poly(p);
+    if (a[0] != 1.0) throw std::runtime_error("filter design: section with less than two poles");
+    return {b[0], b[1], b[2], a[1], a[2]};
+}
+
+// pairs poles with their nearest zeros, the poles closest to the unit circle
+// end up in the last sections (scipy zpk2sos, pairing="nearest")
+SosCascade zpkToSos(Zpk zpk) {
+    if (zpk.z.empty() and zpk.p.empty()) return {{zpk.k, 0, 0, 0, 0}};
+
+    if (zpk.z.size() > zpk.p.size()) zpk.p.insert(zpk.p.end(), zpk.z.size() - zpk.p.size(), 0.0);
+    if (zpk.p.size() > zpk.z.size()) zpk.z.insert(zpk.z.end(), zpk.p.size() - zpk.z.size(), 0.0);
+    const size_t n_sections = (zpk.p.size() + 1) / 2;
+    if (zpk.p.size() % 2 == 1) {
+        zpk.p.emplace_back(0.0);
+        zpk.z.emplace_back(0.0);
+    }
+    Roots z = conjugatePairsThenReals(zpk.z);
+    Roots p = conjugatePairsThenReals(zpk.p);
+
+    SosCascade sos(n_sections);
+    for (size_t si = n_sections; si-- > 0;) {
+        const size_t p1_idx = worstPole(p);
+        const complex p1 = p[p1_idx];
+        p.erase(p.begin() + static_cast<long>(p1_idx));
+
+        if (isReal(p1) and countReal(p) == 0) {
+            // last remaining real pole
+            const complex z1 = takeNearest(z, p1, RootKind::real);
+            sos[si] = sectionFromRoots({z1, 0.0}, {p1, 0.0});
+        } else if (p.size() + 1 == z.size() and !isReal(p1) and countReal(p) == 1 and countReal(z) == 1) {
+            // one real pole and one real zero left, this pole must take a complex zero
+            const complex z1 = takeNearest(z, p1, RootKind::complex);
+            sos[si] = sectionFromRoots({z1, std::conj(z1)}, {p1, std::conj(p1)});
+        } else {
+            complex p2 = std::conj(p1);
+            if (isReal(p1)) {
+                const size_t p2_idx = worstPole(p, true);
+                p2 = p[p2_idx];
+                p.erase(p.begin() + static_cast<long>(p2_idx));
+            }
+            if (z.empty()) {
+                sos[si] = sectionFromRoots({}, {p1, p2});
+            } else {
+                const complex z1 = takeNearest(z, p1, RootKind::any);
+                if (!isReal(z1)) {
+                    sos[si] = sectionFromRoots({z1, std::conj(z1)}, {p1, p2});
+                } else if (!z.empty()) {
+                    const complex z2 = takeNearest(z, p1, RootKind::real);
+                    sos[si] = sectionFromRoots({z1, z2}, {p1, p2});
+                } else {
+                    sos[si] = sectionFromRoots({z1}, {p1, p2});
+                }
+            }
+        }
+    }
+
+    // the overall gain goes into the first section
+    sos[0].b0 *= zpk.k;
+    sos[0].b1 *= zpk.k;
+    sos[0].b2 *= zpk.k;
+    return sos;
+}
+
+void checkEdges(BandType band, double f1, double f2, double sampling_rate) {
+    const double nyquist = sampling_rate / 2;
+    if (!(f1 > 0 and f1 < nyquist)) throw std::invalid_argument("filter design: edge frequency must be in (0, fs/2)");
+    if (band == BandType::bandpass or band == BandType::bandstop) {
+        if (!(f2 > f1 and f2 < nyquist)) throw std::invalid_argument("filter design: band edges must satisfy f1 < f2 < fs/2");
+    }
+}
+
+double sinc(double x) {
+    return x == 0.0 ? 1.0 : std::sin(M_PI * x) / (M_PI * x);
+}
+
+// symmetric window of length n (scipy get_window(..., fftbins=False))
+std::vector<double> window(FirWindow type, int n) {
+    std::vector<double> w(n, 1.0);
+    if (n == 1) return w;
+    for (int i = 0; i < n; i++) {
+        const double phase = 2 * M_PI * i / (n - 1);
+        switch (type) {
+            case FirWindow::boxcar: break;
+            case FirWindow::hamming: w[i] = 0.54 - 0.46 * std::cos(phase); break;
+            case FirWindow::hann: w[i] = 0.5 - 0.5 * std::cos(phase); break;
+            case FirWindow::blackman: w[i] = 0.42 - 0.5 * std::cos(phase) + 0.08 * std::cos(2 * phase); break;
+        }
+    }
+    return w;
+}
+
+} // namespace
+
+FilterClass parseFilterClass(const std::string &name) {
+    if (name == "iir") return FilterClass::iir;
+    if (name == "fir") return FilterClass::fir;
+    if (name == "biquad") return FilterClass::biquad;
+    throw std::invalid_argument("Unsupported filter class: " + name);
+}
+
+BandType parseBandType(const std::string &name) {
+    if (name == "lowpass") return BandType::lowpass;
+    if (name == "highpass") return BandType::highpass;
+    if (name == "bandpass") return BandType::bandpass;
+    if (name == "bandstop") return BandType::bandstop;
+    throw std::invalid_argument("Unsupported filter type: " + name);
+}
+
+IirFamily parseIirFamily(const std::string &name) {
+    if (name == "butterworth") return IirFamily::butterworth;
+    if (name == "chebyshev1") return IirFamily::chebyshev1;
+    if (name == "chebyshev2") return IirFamily::chebyshev2;
+    throw std::invalid_argument("Unsupported IIR design: " + name);
+}
+
+FirWindow parseFirWindow(const std::string &name) {
+    if (name == "boxcar") return FirWindow::boxcar;
+    if (name == "hamming") return FirWindow::hamming;
+    if (name == "hann") return FirWindow::hann;
+    if (name == "blackman") return FirWindow::blackman;
+    throw std::invalid_argument("Unsupported FIR window: " + name);
+}
+
+SosCascade designIir(IirFamily family, int order, BandType band, double f1, double f2, double sampling_rate,
+                     double ripple_db, double attenuation_db) {
+    if (order < 1) throw std::invalid_argument("filter design: order must be at least 1");
+    checkEdges(band, f1, f2, sampling_rate);
+
+    // pre-warp the edges for the bilinear transform at fs = 2 (normalised frequencies)
+    constexpr double fs = 2.0;
+    auto warp = [&](double f) { return 2 * fs * std::tan(M_PI * (2 * f / sampling_rate) / fs); };
+
+    Zpk zpk = analogPrototype(family, order, ripple_db, attenuation_db);
+    switch (band) {
+        case BandType::lowpass: lowpassToLowpass(zpk, warp(f1)); break;
+        case BandType::highpass: lowpassToHighpass(zpk, warp(f1)); break;
+        case BandType::bandpass:
+            lowpassToBandpass(zpk, std::sqrt(warp(f1) * warp(f2)), warp(f2) - warp(f1));
+            break;
+        case BandType::bandstop:
+            lowpassToBandstop(zpk, std::sqrt(warp(f1) * warp(f2)), warp(f2) - warp(f1));
+            break;
+    }
+    bilinear(zpk, fs);
+    return zpkToSos(std::move(zpk));
+}
+
+std::vector<double> designFir(int num_taps, BandType band, double f1, double f2, double sampling_rate,
+                              FirWindow window_type) {
+    if (num_taps < 1) throw std::invalid_argument("filter design: at least one tap is needed");
+    checkEdges(band, f1, f2, sampling_rate);
+
+    // band edges normalised to Nyquist, including 0 and 1 where the response passes them
+    const double nyquist = sampling_rate / 2;
+    const bool pass_zero = band == BandType::lowpass or band == BandType::bandstop;
+    const bool two_edges = band == BandType::bandpass or band == BandType::bandstop;
+    const bool pass_nyquist = !two_edges ^ pass_zero;
+    if (pass_nyquist and num_taps % 2 == 0) {
+        throw std::invalid_argument("filter design: a filter passing Nyquist needs an odd number of taps");
+    }
+    std::vector<double> edges;
+    if (pass_zero) edges.push_back(0.0);
+    edges.push_back(f1 / nyquist);
+    if (two_edges) edges.push_back(f2 / nyquist);
+    if (pass_nyquist) edges.push_back(1.0);
+
+    const double alpha = 0.5 * (num_taps - 1);
+    const std::vector<double> w = window(window_type, num_taps);
+    std::vector<double> h(num_taps, 0.0);
+    for (int i = 0; i < num_taps; i++) {
+        const double m = i - alpha;
+        for (size_t e = 0; e < edges.size(); e += 2) {
+            h[i] += edges[e + 1] * sinc(edges[e + 1] * m) - edges[e] * sinc(edges[e] * m);
+        }
+        h[i] *= w[i];
+    }
+
+    // unit gain at DC, at Nyquist or in the centre of the first passband
+    const double left = edges[0], right = edges[1];
+    const double scale_frequency = left == 0.0 ? 0.0 : (right == 1.0 ? 1.0 : 0.5 * (left + right));
+    double gain = 0.0;
+    for (int i = 0; i < num_taps; i++) gain += h[i] * std::cos(M_PI * (i - alpha) * scale_frequency);
+    for (double &c : h) c /= gain;
+    return h;
+}
+
+SosCascade designNotches(double frequency, int harmonics, double q, double sampling_rate) {
+    if (frequency <= 0.0 or frequency >= sampling_rate / 2) {
+        throw std::invalid_argument("filter design: notch frequency must be between 0 and Nyquist");
+    }
+    if (harmonics < 1) throw std::invalid_argument("filter design: at least one notch harmonic");
+    if (q <= 0.0) throw std::invalid_argument("filter design: notch quality factor must be positive");
+
+    SosCascade cascade;
+    for (int harmonic = 1; harmonic <= harmonics and harmonic * frequency < sampling_rate / 2; harmonic++) {
+        // scipy iirnotch: bandwidth f0 / Q at -3 dB, unit gain at DC and Nyquist
+        const double w0 = 2.0 * M_PI * harmonic * frequency / sampling_rate;
+        const double beta = std::tan(w0 / q / 2.0);
+        const double gain = 1.0 / (1.0 + beta);
+        const double c = std::cos(w0);
+        cascade.push_back({gain, -2.0 * gain * c, gain, -2.0 * gain * c, 2.0 * gain - 1.0});
+    }
+    return cascade;
+}
@@ -0,0 +1,42 @@
+#ifndef FILTER_DESIGN_H
+#define FILTER_DESIGN_H
+
+#include <string>
+#include <vector>
+#include "sos.h"
+
+// Native filter design, numerically following scipy.signal so configurations
+// keep their responses: butter/cheby1/cheby2(..., output="sos") and firwin.
+
+// biquad: the single bandpass section at the band centre (Q 0.707) of the original pipeline
+enum class FilterClass { iir, fir, biquad };
+enum class BandType { lowpass, highpass, bandpass, bandstop };
+enum class IirFamily { butterworth, chebyshev1, chebyshev2 };
+enum class FirWindow { boxcar, hamming, hann, blackman };
+
+// parse the names used in the config files, throw std::invalid_argument otherwise
+FilterClass parseFilterClass(const std::string &name);
+BandType parseBandType(const std::string &name);
+IirFamily parseIirFamily(const std::string &name);
+FirWindow parseFirWindow(const std::string &name);
+
+// Digital IIR filter of the given order as second order sections (bilinear
+// transform of the analog prototype with pre-warped edges, poles and zeros
+// paired like scipy's zpk2sos). Edges are in Hz, lowpass and highpass only
+// use f1. ripple_db is the Chebyshev I passband ripple, attenuation_db the
+// Chebyshev II stopband attenuation (whose edges are the stopband edges).
+SosCascade designIir(IirFamily family, int order, BandType band, double f1, double f2, double sampling_rate,
+                     double ripple_db = 1.0, double attenuation_db = 40.0);
+
+// Windowed-sinc FIR filter with num_taps coefficients, scaled to unit gain
+// in the centre of the first passband. Highpass and bandstop need an odd
+// number of taps. Edges as for designIir.
+std::vector<double> designFir(int num_taps, BandType band, double f1, double f2, double sampling_rate,
+                              FirWindow window = FirWindow::hamming);
+
+// Notch sections at frequency and its first `harmonics` multiples (the
+// fundamental included), harmonics at or above Nyquist are left out. Each
+// section rejects a band of harmonic * frequency / q Hz (scipy iirnotch).
+SosCascade designNotches(double frequency, int harmonics, double q, double sampling_rate);
+
+#endif //FILTER_DESIGN_H
@@ -0,0 +1,307 @@
+#include "filter_kernels.h"
+#include <cstddef>
+#include "../../lib/simd.h"
+
+// generic cascade: one section at a time over the whole chunk, the first reads
+// the input, later sections filter the output in place while it is still in L1
+template <typename T>
+static void processSosGeneric(const SosBankView<T> &bank, const T *in, T *out, int n_samples, int stride) {
+    using V = simd::Vec<T>;
+    for (int section = 0; section < bank.n_sections; section++) {
+        const T *src = section == 0 ? in : out;
+        const int offset = section * bank.n_padded;
+        const T cb0 = bank.b0[section], cb1 = bank.b1[section], cb2 = bank.b2[section];
+        const T ca1 = bank.a1[section], ca2 = bank.a2[section];
+        const V vb0 = V::broadcast(cb0), vb1 = V::broadcast(cb1), vb2 = V::broadcast(cb2);
+        const V va1 = V::broadcast(ca1), va2 = V::broadcast(ca2);
+        int c = 0;
+
+        // full vectors: keep coefficients and state of the channel block in registers for the whole chunk
+        for (; c + V::width <= bank.n_channel; c += V::width) {
+            const int i = offset + c;
+            V vz1 = V::load(&bank.z1[i]), vz2 = V::load(&bank.z2[i]);
+            for (int s = 0; s < n_samples; s++) {
+                const V x = V::loadu(src + s * stride + c);
+                const V y = fmadd(x, vb0, vz1);
+                vz1 = fnmadd(va1, y, fmadd(x, vb1, vz2));
+                vz2 = fnmadd(va2, y, x * vb2);
+                y.storeu(out + s * stride + c);
+            }
+            vz1.store(&bank.z1[i]);
+            vz2.store(&bank.z2[i]);
+        }
+
+        // remaining channels
+        for (; c < bank.n_channel; c++) {
+            const int i = offset + c;
+            T s1 = bank.z1[i], s2 = bank.z2[i];
+            for (int s = 0; s < n_samples; s++) {
+                const T x = src[s * stride + c];
+                const T y = x * cb0 + s1;
+                s1 = x * cb1 + s2 - ca1 * y;
+                s2 = x * cb2 - ca2 * y;
+                out[s * stride + c] = y;
+            }
+            bank.z1[i] = s1;
+            bank.z2[i] = s2;
+        }
+    }
+}
+
+// robust noise update of one output (as RobustNoiseEstimator::update)
+template <typename T>
+static inline void updateNoise(simd::Vec<T> y, simd::Vec<T> alpha, simd::Vec<T> &mean_abs, simd::Vec<T> &median_abs) {
+    using V = simd::Vec<T>;
+    const V ay = abs(y);
+    mean_abs = fmadd(alpha, ay - mean_abs, mean_abs);
+    median_abs = fmadd(alpha * mean_abs, select_gt(ay, median_abs, V::broadcast(1), V::broadcast(-1)), median_abs);
+}
+
+template <typename T>
+static inline void updateNoise(T y, T alpha, T &mean_abs, T &median_abs) {
+    const T ay = y < 0 ? -y : y;
+    mean_abs += alpha * (ay - mean_abs);
+    median_abs += alpha * mean_abs * (ay > median_abs ? T(1) : T(-1));
+}
+
+template <typename T>
+void updateNoiseAndDetect(const NoiseView<T> &noise, const T *y, int n_samples, int stride, int n_channel,
+                          uint32_t *crossings) {
+    using V = simd::Vec<T>;
+    const V valpha = V::broadcast(noise.alpha);
+    const int n_blocks = (n_channel + V::width - 1) / V::width;
+    int c = 0;
+    for (; c + V::width <= n_channel; c += V::width) {
+        V ma = V::load(&noise.mean_abs[c]), med = V::load(&noise.median_abs[c]);
+        const V threshold = V::load(&noise.threshold[c]);
+        for (int s = 0; s < n_samples; s++) {
+            const V x = V::loadu(y + s * stride + c);
+            updateNoise(x, valpha, ma, med);
+            crossings[s * n_blocks + c / V::width] = mask_gt(threshold, x);
+        }
+        ma.store(&noise.mean_abs[c]);
+        med.store(&noise.median_abs[c]);
+    }
+    if (c < n_channel) {
+        for (int s = 0; s < n_samples; s++) crossings[s * n_blocks + c / V::width] = 0;
+    }
+    for (; c < n_channel; c++) {
+        T ma = noise.mean_abs[c], med = noise.median_abs[c];
+        for (int s = 0; s < n_samples; s++) {
+            const T x = y[s * stride + c];
+            updateNoise(x, noise.alpha, ma, med);
+            crossings[s * n_blocks + c / V::width] |= uint32_t(x < noise.threshold[c]) << (c % V::width);
+        }
+        noise.mean_abs[c] = ma;
+        noise.median_abs[c] = med;
+    }
+}
+
+// The specialised cascade. Fused: each output also updates the noise
+// estimate of its channel and is compared against the cached threshold
+// while it is still in a register, so the noise state of a channel block
+// stays in registers next to the filter state for the chunk.
+template <int Sections, bool Fused, typename T>
+static void processCascade(const SosBankView<T> &bank, const NoiseView<T> *noise, const T *in, T *out, int n_samples,
+                           int stride, uint32_t *crossings) {
+    using V = simd::Vec<T>;
+    // local copies, the compiler cannot keep coefficients that might alias `out` in registers
+    V vb0[Sections], vb1[Sections], vb2[Sections], va1[Sections], va2[Sections];
+    T cb0[Sections], cb1[Sections], cb2[Sections], ca1[Sections], ca2[Sections];
+    simd::unrolled<Sections>([&](auto k) {
+        cb0[k] = bank.b0[k]; cb1[k] = bank.b1[k]; cb2[k] = bank.b2[k];
+        ca1[k] = bank.a1[k]; ca2[k] = bank.a2[k];
+        vb0[k] = V::broadcast(cb0[k]); vb1[k] = V::broadcast(cb1[k]); vb2[k] = V::broadcast(cb2[k]);
+        va1[k] = V::broadcast(ca1[k]); va2[k] = V::broadcast(ca2[k]);
+    });
+    const T alpha = Fused ? noise->alpha : T(0);
+    const V valpha = V::broadcast(alpha);
+    const int n_blocks = (bank.n_channel + V::width - 1) / V::width;
+    int c = 0;
+
+    // full vectors: a sample passes all sections in registers, so consecutive
+    // samples overlap in different sections instead of waiting for each other
+    for (; c + V::width <= bank.n_channel; c += V::width) {
+        V z1[Sections], z2[Sections];
+        simd::unrolled<Sections>([&](auto k) {
+            z1[k] = V::load(&bank.z1[k * bank.n_padded + c]);
+            z2[k] = V::load(&bank.z2[k * bank.n_padded + c]);
+        });
+        V ma, med, threshold;
+        if constexpr (Fused) {
+            ma = V::load(&noise->mean_abs[c]);
+            med = V::load(&noise->median_abs[c]);
+            threshold = V::load(&noise->threshold[c]);
+        }
+        for (int s = 0; s < n_samples; s++) {
+            V x = V::loadu(in + s * stride + c);
+            simd::unrolled<Sections>([&](auto k) {
+                const V y = fmadd(x, vb0[k], z1[k]);
+                z1[k] = fnmadd(va1[k], y, fmadd(x, vb1[k], z2[k]));
+                z2[k] = fnmadd(va2[k], y, x * vb2[k]);
+                x = y;
+            });
+            x.storeu(out + s * stride + c);
+            if constexpr (Fused) {
+                updateNoise(x, valpha, ma, med);
+                crossings[s * n_blocks + c / V::width] = mask_gt(threshold, x);
+            }
+        }
+        simd::unrolled<Sections>([&](auto k) {
+            z1[k].store(&bank.z1[k * bank.n_padded + c]);
+            z2[k].store(&bank.z2[k * bank.n_padded + c]);
+        });
+        if constexpr (Fused) {
+            ma.store(&noise->mean_abs[c]);
+            med.store(&noise->median_abs[c]);
+        }
+    }
+
+    // remaining channels, they share the last mask word
+    if (Fused and c < bank.n_channel) {
+        for (int s = 0; s < n_samples; s++) crossings[s * n_blocks + c / V::width] = 0;
+    }
+    for (; c < bank.n_channel; c++) {
+        T s1[Sections], s2[Sections];
+        simd::unrolled<Sections>([&](auto k) {
+            s1[k] = bank.z1[k * bank.n_padded + c];
+            s2[k] = bank.z2[k * bank.n_padded + c];
+        });
+        T ma = 0, med = 0;
+        if constexpr (Fused) {
+            ma = noise->mean_abs[c];
+            med = noise->median_abs[c];
+        }
+        for (int s = 0; s < n_samples; s++) {
+            T x = in[s * stride + c];
+            simd::unrolled<Sections>([&](auto k) {
+                const T y = x * cb0[k] + s1[k];
+                s1[k] = x * cb1[k] + s2[k] - ca1[k] * y;
+                s2[k] = x * cb2[k] - ca2[k] * y;
+                x = y;
+            });
+            out[s * stride + c] = x;
+            if constexpr (Fused) {
+                updateNoise(x, alpha, ma, med);
+                crossings[s * n_blocks + c / V::width] |= uint32_t(x < noise->threshold[c]) << (c % V::width);
+            }
+        }
+        simd::unrolled<Sections>([&](auto k) {
+            bank.z1[k * bank.n_padded + c] = s1[k];
+            bank.z2[k * bank.n_padded + c] = s2[k];
+        });
+        if constexpr (Fused) {
+            noise->mean_abs[c] = ma;
+            noise->median_abs[c] = med;
+        }
+    }
+}
+
+template <int Sections, typename T>
+void IirKernel<Sections, T>::process(const SosBankView<T> &bank, const T *in, T *out, int n_samples, int stride) {
+    if constexpr (Sections == 0) {
+        processSosGeneric(bank, in, out, n_samples, stride);
+    } else {
+        processCascade<Sections, false, T>(bank, nullptr, in, out, n_samples, stride, nullptr);
+    }
+}
+
+template <int Sections, typename T>
+void IirKernel<Sections, T>::processDetect(const SosBankView<T> &bank, const NoiseView<T> &noise, const T *in, T *out,
+                                           int n_samples, int stride, uint32_t *crossings) {
+    if constexpr (Sections == 0) {
+        // the generic cascade makes one pass per section anyway, the outputs are still in L1
+        processSosGeneric(bank, in, out, n_samples, stride);
+        updateNoiseAndDetect(noise, out, n_samples, stride, bank.n_channel, crossings);
+    } else {
+        processCascade<Sections, true, T>(bank, &noise, in, out, n_samples, stride, crossings);
+    }
+}
+
+template <int Taps, typename T>
+void FirKernel<Taps, T>::process(const FirBankView<T> &bank, T *out, int n_samples, int stride) {
+    using V = simd::Vec<T>;
+    // with Taps fixed the tap loops have constant trip counts; four accumulators
+    // break the dependency chain of the multiply-adds
+    const int n_taps = Taps > 0 ? Taps : bank.n_taps;
+    const int n_unrolled = n_taps & ~3;
+    const T *h = bank.taps;
+    const ptrdiff_t frame = bank.n_padded;
+
+    for (int s = 0; s < n_samples; s++) {
+        // frame n_taps - 1 + s is the newest sample, tap k reads k frames back
+        const T *newest = bank.history + (n_taps - 1 + s) * frame;
+        T *y = out + s * stride;
+        int c = 0;
+        for (; c + V::width <= bank.n_channel; c += V::width) {
+            const T *x = newest + c;
+            V acc0 = V::zero(), acc1 = V::zero(), acc2 = V::zero(), acc3 = V::zero();
+            int k = 0;
+            for (; k < n_unrolled; k += 4) {
+                acc0 = fmadd(V::broadcast(h[k]), V::load(x - k * frame), acc0);
+                acc1 = fmadd(V::broadcast(h[k + 1]), V::load(x - (k + 1) * frame), acc1);
+                acc2 = fmadd(V::broadcast(h[k + 2]), V::load(x - (k + 2) * frame), acc2);
+                acc3 = fmadd(V::broadcast(h[k + 3]), V::load(x - (k + 3) * frame), acc3);
+            }
+            for (; k < n_taps; k++) acc0 = fmadd(V::broadcast(h[k]), V::load(x - k * frame), acc0);
+            ((acc0 + acc1) + (acc2 + acc3)).storeu(y + c);
+        }
+        for (; c < bank.n_channel; c++) {
+            T acc = 0;
+            for (int k = 0; k < n_taps; k++) acc += h[k] * newest[c - k * frame];
+            y[c] = acc;
+        }
+    }
+}
+
+// select(std::integral_constant<int, n>) for the specialised section counts, select(<0>) otherwise
+template <typename Select>
+static auto bySectionCount(int n_sections, Select select) {
+    // IIR orders 1 - 16 (lowpass / highpass) and 1 - 8 (bandpass / bandstop),
+    // up to four more sections for line noise notches
+    switch (n_sections) {
+        case 1: return select(std::integral_constant<int, 1>{});
+        case 2: return select(std::integral_constant<int, 2>{});
+        case 3: return select(std::integral_constant<int, 3>{});
+        case 4: return select(std::integral_constant<int, 4>{});
+        case 5: return select(std::integral_constant<int, 5>{});
+        case 6: return select(std::integral_constant<int, 6>{});
+        case 7: return select(std::integral_constant<int, 7>{});
+        case 8: return select(std::integral_constant<int, 8>{});
+        case 9: return select(std::integral_constant<int, 9>{});
+        case 10: return select(std::integral_constant<int, 10>{});
+        case 11: return select(std::integral_constant<int, 11>{});
+        case 12: return select(std::integral_constant<int, 12>{});
+        default: return select(std::integral_constant<int, 0>{});
+    }
+}
+
+template <typename T>
+IirKernelFn<T> selectIirKernel(int n_sections) {
+    return bySectionCount(n_sections, [](auto sections) { return &IirKernel<sections(), T>::process; });
+}
+
+template <typename T>
+IirDetectKernelFn<T> selectIirDetectKernel(int n_sections) {
+    return bySectionCount(n_sections, [](auto sections) { return &IirKernel<sections(), T>::processDetect; });
+}
+
+template <typename T>
+FirKernelFn<T> selectFirKernel(int n_taps) {
+    switch (n_taps) {
+        case 15: return &FirKernel<15, T>::process;
+        case 31: return &FirKernel<31, T>::process;
+        case 63: return &FirKernel<63, T>::process;
+        case 127: return &FirKernel<127, T>::process;
+        default: return &FirKernel<0, T>::process;
+    }
+}
+
+template IirKernelFn<float> selectIirKernel<float>(int);
+template IirKernelFn<double> selectIirKernel<double>(int);
+template IirDetectKernelFn<float> selectIirDetectKernel<float>(int);
+template IirDetectKernelFn<double> selectIirDetectKernel<double>(int);
+template FirKernelFn<float> selectFirKernel<float>(int);
+template FirKernelFn<double> selectFirKernel<double>(int);
+template void updateNoiseAndDetect<float>(const NoiseView<float> &, const float *, int, int, int, uint32_t *);
+template void updateNoiseAndDetect<double>(const NoiseView<double> &, const double *, int, int, int, uint32_t *);
@@ -0,0 +1,82 @@
+#ifndef FILTER_KERNELS_H
+#define FILTER_KERNELS_H
+
+#include <cstdint>
+
+// Filter loops specialised at compile time for the number of sections / taps.
+// The loop over sections is unrolled by the template, so a channel block keeps
+// the state of a whole cascade in registers and a sample runs through all
+// sections before it is stored; tap loops get a constant trip count. The size
+// 0 instantiations are the generic kernels for any size. Banks pick their
+// kernel once when their coefficients are set, not per sample.
+
+// Coefficients and state of a BiquadBank
+template <typename T>
+struct SosBankView {
+    const T *b0, *b1, *b2, *a1, *a2;    // [section]
+    T *z1, *z2;                         // [section * n_padded + channel]
+    int n_sections;
+    int n_channel;
+    int n_padded;
+};
+
+// Taps and time-major history of a direct form FirBank
+template <typename T>
+struct FirBankView {
+    const T *taps;
+    int n_taps;
+    const T *history;   // [frame][n_padded], frame n_taps - 1 is the first sample to filter
+    int n_channel;
+    int n_padded;
+};
+
+// Noise estimate of a RobustNoiseEstimator, updated by the detecting kernels
+template <typename T>
+struct NoiseView {
+    T *mean_abs, *median_abs;   // [channel]
+    const T *threshold;         // [channel] cached detection thresholds
+    T alpha;                    // forgetting factor per sample
+};
+
+// The detecting kernels report crossings (outputs below the threshold of
+// their channel) as bitmasks, crossings[sample * n_blocks + c / W] has bit
+// c % W set for channel c, W = simd::Vec<T>::width, n_blocks = ceil(n_channel / W).
+
+template <int Sections, typename T>
+struct IirKernel {
+    // filters n_samples time steps, in/out are `stride` values apart per sample
+    static void process(const SosBankView<T> &bank, const T *in, T *out, int n_samples, int stride);
+
+    // process fused with the noise update and the threshold comparison of every output
+    static void processDetect(const SosBankView<T> &bank, const NoiseView<T> &noise, const T *in, T *out, int n_samples,
+                              int stride, uint32_t *crossings);
+};
+
+template <int Taps, typename T>
+struct FirKernel {
+    // writes n_samples outputs from the history, `stride` values apart per sample
+    static void process(const FirBankView<T> &bank, T *out, int n_samples, int stride);
+};
+
+template <typename T>
+using IirKernelFn = void (*)(const SosBankView<T> &, const T *, T *, int, int);
+template <typename T>
+using IirDetectKernelFn = void (*)(const SosBankView<T> &, const NoiseView<T> &, const T *, T *, int, int, uint32_t *);
+template <typename T>
+using FirKernelFn = void (*)(const FirBankView<T> &, T *, int, int);
+
+// the kernel specialised for this size if there is one, the generic one otherwise
+template <typename T>
+IirKernelFn<T> selectIirKernel(int n_sections);
+template <typename T>
+IirDetectKernelFn<T> selectIirDetectKernel(int n_sections);
+template <typename T>
+FirKernelFn<T> selectFirKernel(int n_taps);
+
+// the noise update and threshold comparison of IirKernel::processDetect as a
+// separate pass over filtered samples, for the other filter banks
+template <typename T>
+void updateNoiseAndDetect(const NoiseView<T> &noise, const T *y, int n_samples, int stride, int n_channel,
+                          uint32_t *crossings);
+
+#endif //FILTER_KERNELS_H
@@ -0,0 +1,27 @@
+#ifndef SOS_H
+#define SOS_H
+
+#include "../../lib/aligned_allocator.h"
+
+// One second order section normalised to a0 == 1:
+// H(z) = (b0 + b1 z^-1 + b2 z^-2) / (1 + a1 z^-1 + a2 z^-2)
+struct SosSection {
+    double b0, b1, b2;
+    double a1, a2;
+};
+
+// A cascade of sections, evaluated in order. Any IIR order maps to
+// ceil(order / 2) sections, which stays well conditioned where the
+// expanded b/a polynomials of high order band filters do not.
+using SosCascade = aligned_vector<SosSection>;
+
+// One time step of a section in transposed direct form II. z points to the
+// two state values of the section.
+inline double processSection(const SosSection &s, double *z, double x) {
+    const double y = s.b0 * x + z[0];
+    z[0] = s.b1 * x - s.a1 * y + z[1];
+    z[1] = s.b2 * x - s.a2 * y;
+    return y;
+}
+
+#endif //SOS_H
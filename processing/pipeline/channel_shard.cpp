@@ -0,0 +1,133 @@
+#include "channel_shard.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include "../filter/filter_coefficients.h"
+#include "../../lib/simd.h"
+
+template <typename T>
+ChannelShard<T>::ChannelShard(const Config &cfg, int first_channel, int n_channel, HistoryBuffer<T> *history,
+                              PipelineMetrics *metrics)
+    : first_channel(first_channel), n_channel(n_channel), sampling_rate(cfg.sampling_rate),
+      chunk_size(cfg.buffer.chunk_size), warmup_samples(std::lround(cfg.detector.warmup * cfg.sampling_rate)),
+      filter(cfg.filter), history(history), metrics(metrics),
+      biquad_bank(n_channel, 1, parseIirMode(cfg.filter.iir_mode)),
+      spike_detector(makeSpikeDetector<T>(cfg, first_channel, n_channel)),
+      detector(n_channel, simd::Vec<T>::width, cfg.buffer.chunk_size, first_channel),
+      crossings(static_cast<size_t>(cfg.buffer.chunk_size) * detector.getBlockCount()) {
+    setFilter(cfg.filter);
+}
+
+template <typename T>
+bool ChannelShard<T>::setFilter(const FilterConfig &new_filter) {
+    const FilterClass filter_class = parseFilterClass(new_filter.filter_class);
+    const IirMode iir_mode = parseIirMode(new_filter.iir_mode);
+    const FirMode fir_mode = parseFirMode(new_filter.fir_mode);
+    if (new_filter.fixed_point and filter_class != FilterClass::iir) {
+        throw std::runtime_error("filter.fixed_point needs filter.class iir, not " + new_filter.filter_class);
+    }
+    const auto coefficients = getFilterCoefficients(FilterDesign::fromConfig(new_filter, sampling_rate));
+    const int n_sections = static_cast<int>(coefficients->sections.size());
+    bool kept;
+    if (new_filter.fixed_point) {
+        // the same design, quantised to the int16 / int32 arithmetic of a hardware front end
+        if (fixed_bank and fixed_bank->getFractionBits() == new_filter.fraction_bits) {
+            kept = fixed_bank->getSectionCount() == n_sections;
+            fixed_bank->setSections(coefficients->sections);
+        } else {
+            auto bank = std::make_unique<FixedBiquadBank>(n_channel, new_filter.fraction_bits);
+            bank->setSections(coefficients->sections);
+            fixed_bank = std::move(bank);
+            kept = false;
+        }
+        fixed_in.resize(static_cast<size_t>(chunk_size) * n_channel);
+        fixed_out.resize(static_cast<size_t>(chunk_size) * n_channel);
+        fir_bank.reset();
+    } else if (filter_class == FilterClass::fir) {
+        // a design of the same length runs over the current delay line, with the engine timed before
+        kept = fir_bank and fir_bank->getTapCount() == static_cast<int>(coefficients->taps.size()) and
+               new_filter.fir_mode == filter.fir_mode;
+        if (kept) fir_bank->setTaps(coefficients);
+        else fir_bank = std::make_unique<FirBank<T>>(n_channel, coefficients, chunk_size, fir_mode);
+        // the taps cannot hold the notches, the biquad bank runs them over the FIR output
+        if (coefficients->n_notches > 0) {
+            kept = kept and filter.notch > 0 and biquad_bank.getSectionCount() == n_sections;
+            biquad_bank.setSections(coefficients->sections);
+        }
+        fixed_bank.reset();
+    } else {
+        // the configured design (shared with the other shards), run as a cascade of second order sections;
+        // the state carries over from a cascade of the same length, in either engine
+        kept = !fir_bank and !fixed_bank and biquad_bank.getSectionCount() == n_sections;
+        if (new_filter.iir_mode != filter.iir_mode) biquad_bank.setMode(iir_mode);
+        biquad_bank.setSections(coefficients->sections);
+        fixed_bank.reset();
+        fir_bank.reset();
+    }
+    filter = new_filter;
+    return kept;
+}
+
+template <typename T>
+void ChannelShard<T>::processChunk(const T *chunk, T *filtered, int n_samples, int stride, long first_sample_idx) {
+    uint64_t start = PipelineMetrics::now();
+    // the detector's noise thresholds are refreshed between segments
+    int s = 0;
+    while (s < n_samples) {
+        const long sample_idx = first_sample_idx + s;
+        const int n = spike_detector->segmentLength(sample_idx, n_samples - s);
+        filterAndDetect(chunk + first_channel + s * stride, filtered + first_channel + s * stride, n, stride,
+                        &crossings[static_cast<size_t>(s) * detector.getBlockCount()]);
+        spike_detector->endSegment(sample_idx + n);
+        s += n;
+    }
+    for (int channel = 0; channel < n_channel; channel++) {
+        history->writeChannel(first_channel + channel, first_sample_idx, filtered + first_channel + channel, n_samples, stride);
+    }
+    metrics->record(Stage::filter, start);
+
+    start = PipelineMetrics::now();
+    // After the warm-up, a crossing outside the refractory period is a spike,
+    // dated back by the delay of the detector
+    detector.process(crossings.data(), n_samples, first_sample_idx - spike_detector->getDelay(), warmup_samples);
+    metrics->record(Stage::detect, start);
+}
+
+template <typename T>
+void ChannelShard<T>::filterAndDetect(const T *in, T *out, int n_samples, int stride, uint32_t *segment_crossings) {
+    const NoiseView<T> *fused_noise = spike_detector->getFusedNoise();
+    if (not fixed_bank and not fir_bank and fused_noise) {
+        biquad_bank.processChunkDetect(in, out, n_samples, stride, *fused_noise, segment_crossings);
+        return;
+    }
+    if (fixed_bank) {
+        processFixedPoint(in, out, n_samples, stride);
+    } else if (fir_bank) {
+        fir_bank->processChunk(in, out, n_samples, stride);
+        if (filter.notch > 0) biquad_bank.processChunk(out, out, n_samples, stride);
+    } else {
+        biquad_bank.processChunk(in, out, n_samples, stride);
+    }
+    spike_detector->detect(out, n_samples, stride, segment_crossings);
+}
+
+template <typename T>
+void ChannelShard<T>::processFixedPoint(const T *in, T *out, int n_samples, int stride) {
+    // the samples are int16 ADC values, rounding only matters for converted streams
+    for (int s = 0; s < n_samples; s++) {
+        const T *row = in + s * stride;
+        int16_t *fixed_row = &fixed_in[static_cast<size_t>(s) * n_channel];
+        for (int channel = 0; channel < n_channel; channel++) {
+            fixed_row[channel] = static_cast<int16_t>(std::clamp<T>(std::nearbyint(row[channel]), INT16_MIN, INT16_MAX));
+        }
+    }
+    fixed_bank->processChunk(fixed_in.data(), fixed_out.data(), n_samples, n_channel);
+    for (int s = 0; s < n_samples; s++) {
+        const int16_t *fixed_row = &fixed_out[static_cast<size_t>(s) * n_channel];
+        T *row = out + s * stride;
+        for (int channel = 0; channel < n_channel; channel++) row[channel] = fixed_row[channel];
+    }
+}
+
+template class ChannelShard<float>;
+template class ChannelShard<double>;
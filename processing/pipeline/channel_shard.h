@@ -0,0 +1,75 @@
+#ifndef CHANNEL_SHARD_H
+#define CHANNEL_SHARD_H
+
+#include <memory>
+#include <span>
+#include <vector>
+#include "../../lib/config.h"
+#include "../filter/BiquadBank.h"
+#include "../filter/FirBank.h"
+#include "../filter/FixedBiquadBank.h"
+#include "../spikesorting/crossing_detector.h"
+#include "../spikesorting/spike_detector.h"
+#include "../spikesorting/spike_event.h"
+#include "history_buffer.h"
+#include "metrics.h"
+
+// A contiguous range of channels with its own filter, noise and detector
+// state. Shards never share mutable state, so each can run on its own thread.
+template <typename T>
+class ChannelShard {
+public:
+    ChannelShard(const Config &cfg, int first_channel, int n_channel, HistoryBuffer<T> *history,
+                 PipelineMetrics *metrics);
+
+    // Filters and detects spikes for this shard's columns of a
+    // channel-interleaved chunk (stride = total channel count). The filtered
+    // samples are also appended to this shard's history rows. With the
+    // amplitude detector, IIR banks in channel mode filter, update the noise
+    // estimates and compare against the thresholds in one pass, each sample
+    // against the threshold cached before its noise update segment.
+    void processChunk(const T *chunk, T *filtered, int n_samples, int stride, long first_sample_idx);
+
+    // Replaces the filter between chunks. The noise estimates, the detector
+    // state and the history are kept. The filter state carries over to
+    // cascades with as many sections (in either iir_mode, also after an
+    // iir_mode change), fixed point with the same fraction_bits, and FIR
+    // designs with as many taps and the same fir_mode, which also keep the
+    // engine chosen by fir_mode auto. Any other change starts the new bank
+    // from zero state, with a transient as long as the filter's impulse
+    // response, and a new FIR bank with fir_mode auto times its engines
+    // again; false is returned then. Throws before changing anything if the
+    // design is invalid.
+    bool setFilter(const FilterConfig &filter);
+
+    // spike events of the last chunk, in sample order
+    [[nodiscard]] std::span<const SpikeEvent> getSpikeEvents() const { return detector.getEvents(); }
+
+    [[nodiscard]] int getFirstChannel() const { return first_channel; }
+    [[nodiscard]] int getChannelCount() const { return n_channel; }
+
+private:
+    int first_channel;
+    int n_channel;
+    int sampling_rate;
+    int chunk_size;
+    long warmup_samples;        // no detection before the noise estimate settled
+    FilterConfig filter;        // the current filter settings
+    HistoryBuffer<T> *history;
+    PipelineMetrics *metrics;
+    BiquadBank<T> biquad_bank;              // the IIR cascade, or the notches behind the FIR bank
+    std::unique_ptr<FirBank<T>> fir_bank;   // filter.class fir, replaces the biquad bank
+    std::unique_ptr<FixedBiquadBank> fixed_bank;    // filter.fixed_point, replaces the biquad bank
+    std::vector<int16_t> fixed_in, fixed_out;       // this shard's columns of a chunk, [sample][channel]
+    std::unique_ptr<SpikeDetector<T>> spike_detector;   // detector.type, writes the crossing masks
+    CrossingDetector detector;
+    std::vector<uint32_t> crossings;    // threshold crossing masks of the current chunk, [sample][block]
+
+    // filters one segment of the spike detector and writes its crossing masks,
+    // in one fused pass where the filter bank has a kernel for the detector
+    void filterAndDetect(const T *in, T *out, int n_samples, int stride, uint32_t *segment_crossings);
+    // quantises the shard's columns to int16, filters them in fixed point and converts back
+    void processFixedPoint(const T *in, T *out, int n_samples, int stride);
+};
+
+#endif //CHANNEL_SHARD_H
@@ -0,0 +1,30 @@
+#include "config_watcher.h"
+#include <cmath>
+#include <exception>
+#include <iostream>
+#include <utility>
+
+ConfigWatcher::ConfigWatcher(std::string path, const Config &cfg)
+    : path(std::move(path)),
+      interval_samples(cfg.control.watch ? std::lround(cfg.control.interval * cfg.sampling_rate) : 0),
+      next_check_idx(interval_samples) {
+    std::error_code error;
+    last_write = std::filesystem::last_write_time(this->path, error);
+}
+
+std::optional<Config> ConfigWatcher::poll(long sample_idx) {
+    next_check_idx = sample_idx + interval_samples;
+
+    std::error_code error;
+    const auto write_time = std::filesystem::last_write_time(path, error);
+    if (error or write_time == last_write) return std::nullopt;
+
+    // a broken file is reported once, the next save is picked up again
+    last_write = write_time;
+    try {
+        return readConfig(path);
+    } catch (const std::exception &e) {
+        std::cerr << "Ignoring changed config " << path << ": " << e.what() << std::endl;
+        return std::nullopt;
+    }
+}
@@ -0,0 +1,29 @@
+#ifndef CONFIG_WATCHER_H
+#define CONFIG_WATCHER_H
+
+#include <filesystem>
+#include <optional>
+#include <string>
+#include "../../lib/config.h"
+
+// Polls the modification time of the config file every control.interval
+// seconds of signal. A changed file is parsed again; a file that does not
+// parse (e.g. saved half way) is reported and skipped, the running
+// configuration stays in place.
+class ConfigWatcher {
+public:
+    ConfigWatcher(std::string path, const Config &cfg);
+
+    [[nodiscard]] bool due(long sample_idx) const { return interval_samples > 0 and sample_idx >= next_check_idx; }
+
+    // the new configuration if the file changed since the last check
+    std::optional<Config> poll(long sample_idx);
+
+private:
+    std::string path;
+    long interval_samples;
+    long next_check_idx;
+    std::filesystem::file_time_type last_write;
+};
+
+#endif //CONFIG_WATCHER_H
@@ -0,0 +1,61 @@
+#ifndef HISTORY_BUFFER_H
+#define HISTORY_BUFFER_H
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstring>
+#include <span>
+#include "../../lib/aligned_allocator.h"
+
+// Fixed-size circular history of the filtered signal, stored channel-major:
+// every channel owns one contiguous row of a power-of-two length, indexed by
+// the absolute sample index masked to the row length. Shards write disjoint
+// rows, readers copy out (or get a span of) any range still in the history.
+template <typename T>
+class HistoryBuffer {
+public:
+    HistoryBuffer(int n_channel, std::size_t min_length)
+        : n_channel(n_channel), length(std::bit_ceil(std::max<std::size_t>(min_length, 1))), mask(length - 1),
+          data(static_cast<std::size_t>(n_channel) * length, T(0)) {}
+
+    // stores n samples of one channel, read with the given stride, from absolute index first_idx on
+    void writeChannel(int channel, long first_idx, const T *src, int n, int stride) {
+        T *row = &data[channel * length];
+        for (int s = 0; s < n; s++) {
+            row[(first_idx + s) & mask] = src[s * stride];
+        }
+    }
+
+    // copies len samples of a channel starting at absolute index start
+    void copy(int channel, long start, int len, T *dst) const {
+        const T *row = &data[channel * length];
+        const std::size_t pos = start & mask;
+        const std::size_t first = std::min<std::size_t>(len, length - pos);
+        std::memcpy(dst, row + pos, first * sizeof(T));
+        std::memcpy(dst + first, row, (len - first) * sizeof(T));
+    }
+
+    // view without copying, empty if the range wraps around the end of the row
+    [[nodiscard]] std::span<const T> span(int channel, long start, int len) const {
+        const std::size_t pos = start & mask;
+        if (pos + len > length) return {};
+        return {&data[channel * length + pos], static_cast<std::size_t>(len)};
+    }
+
+    // true if [start, start + len) is written and not yet overwritten, given n_written samples so far
+    [[nodiscard]] bool contains(long start, int len, long n_written) const {
+        return start >= 0 and start + len <= n_written and n_written - start <= static_cast<long>(length);
+    }
+
+    [[nodiscard]] std::size_t getLength() const { return length; }
+    [[nodiscard]] int getChannelCount() const { return n_channel; }
+
+private:
+    int n_channel;
+    std::size_t length;
+    std::size_t mask;
+    aligned_vector<T> data;
+};
+
+#endif //HISTORY_BUFFER_H
@@ -0,0 +1,158 @@
+#include "metrics.h"
+#include <bit>
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+
+const char *stageName(Stage stage) {
+    switch (stage) {
+        case Stage::pull: return "pull";
+        case Stage::filter: return "filter";
+        case Stage::detect: return "detect";
+        case Stage::extract: return "extract";
+        case Stage::infer: return "infer";
+        case Stage::push: return "push";
+        case Stage::record: return "record";
+        case Stage::lfp: return "lfp";
+        case Stage::reference: return "reference";
+    }
+    return "unknown";
+}
+
+int LatencyHistogram::bucketIndex(uint64_t ns) {
+    if (ns < static_cast<uint64_t>(sub_bucket_count)) return static_cast<int>(ns);
+    // v in [2^e, 2^(e+1)) is split into sub_bucket_count buckets of width 2^shift
+    const int shift = static_cast<int>(std::bit_width(ns)) - 1 - sub_bucket_bits;
+    const auto mantissa = static_cast<int>(ns >> shift);
+    return (shift + 1) * sub_bucket_count + mantissa - sub_bucket_count;
+}
+
+uint64_t LatencyHistogram::bucketValue(int index) {
+    const int block = index / sub_bucket_count;
+    if (block == 0) return index;
+    const int shift = block - 1;
+    const uint64_t lower = static_cast<uint64_t>(sub_bucket_count + index % sub_bucket_count) << shift;
+    return lower + ((uint64_t{1} << shift) >> 1);
+}
+
+void LatencyHistogram::record(uint64_t ns) {
+    counts[bucketIndex(ns)].fetch_add(1, std::memory_order_relaxed);
+    uint64_t current = max.load(std::memory_order_relaxed);
+    while (ns > current and !max.compare_exchange_weak(current, ns, std::memory_order_relaxed)) {}
+}
+
+void LatencyHistogram::drain(Snapshot &snapshot) {
+    snapshot.total = 0;
+    for (int i = 0; i < bucket_count; i++) {
+        snapshot.counts[i] = counts[i].exchange(0, std::memory_order_relaxed);
+        snapshot.total += snapshot.counts[i];
+    }
+    snapshot.max = max.exchange(0, std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::Snapshot::percentile(double q) const {
+    if (total == 0) return 0;
+    const auto target = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(q * static_cast<double>(total))));
+    uint64_t cumulative = 0;
+    for (int i = 0; i < bucket_count; i++) {
+        cumulative += counts[i];
+        if (cumulative >= target) return std::min(bucketValue(i), max);
+    }
+    return max;
+}
+
+MetricsReporter::MetricsReporter(const Config &cfg, PipelineMetrics *metrics)
+    : metrics(metrics), sampling_rate(cfg.sampling_rate),
+      interval_samples(std::lround(cfg.metrics.interval * cfg.sampling_rate)),
+      next_report_idx(interval_samples), last_report_time(PipelineMetrics::now()),
+      values(stage_count * stage_values + queue_values + rate_values, 0.0) {
+    if (interval_samples <= 0) return;
+    if (cfg.metrics.outlet) {
+        outlet = std::make_unique<lsl::stream_outlet>(setupStreamInfo(cfg));
+        std::cout << "Created LSL Outlet for pipeline metrics" << std::endl;
+    }
+    if (!cfg.metrics.path.empty()) {
+        file.open(cfg.metrics.path, std::ios::out | std::ios::trunc);
+        if (!file) throw std::runtime_error("Cannot open metrics file: " + cfg.metrics.path);
+    }
+}
+
+lsl::stream_info MetricsReporter::setupStreamInfo(const Config &cfg) const {
+    lsl::stream_info info(cfg.stream_name + "_metrics", "Metrics", static_cast<int32_t>(values.size()),
+                          lsl::IRREGULAR_RATE, lsl::cf_double64, cfg.stream_name + "_metrics");
+    lsl::xml_element channels = info.desc().append_child("channels");
+    auto add_channel = [&channels](const std::string &label, const std::string &unit) {
+        channels.append_child("channel").append_child_value("label", label).append_child_value("unit", unit);
+    };
+    for (int s = 0; s < stage_count; s++) {
+        const std::string name = stageName(static_cast<Stage>(s));
+        add_channel(name + "_count", "chunks");
+        add_channel(name + "_p50", "microseconds");
+        add_channel(name + "_p99", "microseconds");
+        add_channel(name + "_p999", "microseconds");
+        add_channel(name + "_max", "microseconds");
+    }
+    add_channel("ring", "samples");
+    add_channel("ring_high_water", "samples");
+    add_channel("ring_dropped", "samples");
+    add_channel("pending_spikes", "spikes");
+    add_channel("inference", "spikes");
+    add_channel("samples_per_second", "Hz");
+    add_channel("detected_spikes_per_second", "Hz");
+    add_channel("classified_spikes_per_second", "Hz");
+    return info;
+}
+
+void MetricsReporter::report(long sample_idx, const QueueDepths &queues) {
+    const uint64_t now = PipelineMetrics::now();
+    const double wall_seconds = static_cast<double>(now - last_report_time) * 1e-9;
+    const double signal_seconds = static_cast<double>(sample_idx - last_report_idx) / sampling_rate;
+
+    double *value = values.data();
+    for (int s = 0; s < stage_count; s++) {
+        metrics->histogram(static_cast<Stage>(s)).drain(snapshot);
+        *value++ = static_cast<double>(snapshot.total);
+        *value++ = static_cast<double>(snapshot.percentile(0.5)) * 1e-3;
+        *value++ = static_cast<double>(snapshot.percentile(0.99)) * 1e-3;
+        *value++ = static_cast<double>(snapshot.percentile(0.999)) * 1e-3;
+        *value++ = static_cast<double>(snapshot.max) * 1e-3;
+    }
+    *value++ = static_cast<double>(queues.ring);
+    *value++ = static_cast<double>(queues.ring_high_water);
+    *value++ = static_cast<double>(queues.ring_dropped);
+    *value++ = static_cast<double>(queues.pending_spikes);
+    *value++ = static_cast<double>(queues.inference);
+
+    // samples/s is the achieved throughput, spike rates are per second of signal
+    const std::array<uint64_t, 3> counters = {metrics->samples.load(std::memory_order_relaxed),
+                                              metrics->detected_spikes.load(std::memory_order_relaxed),
+                                              metrics->classified_spikes.load(std::memory_order_relaxed)};
+    *value++ = wall_seconds > 0 ? static_cast<double>(counters[0] - last_counters[0]) / wall_seconds : 0.0;
+    *value++ = static_cast<double>(counters[1] - last_counters[1]) / signal_seconds;
+    *value++ = static_cast<double>(counters[2] - last_counters[2]) / signal_seconds;
+
+    if (outlet) outlet->push_sample(values);
+    if (file.is_open()) writeJson(static_cast<double>(sample_idx) / sampling_rate);
+
+    last_counters = counters;
+    last_report_time = now;
+    last_report_idx = sample_idx;
+    while (next_report_idx <= sample_idx) next_report_idx += interval_samples;
+}
+
+void MetricsReporter::writeJson(double stream_time) {
+    const double *value = values.data();
+    file << "{\"time\":" << stream_time << ",\"stages\":{";
+    for (int s = 0; s < stage_count; s++, value += stage_values) {
+        file << (s ? "," : "") << "\"" << stageName(static_cast<Stage>(s)) << "\":{"
+             << "\"count\":" << value[0] << ",\"p50_us\":" << value[1] << ",\"p99_us\":" << value[2]
+             << ",\"p999_us\":" << value[3] << ",\"max_us\":" << value[4] << "}";
+    }
+    file << "},\"queues\":{\"ring\":" << value[0] << ",\"ring_high_water\":" << value[1]
+         << ",\"ring_dropped\":" << value[2] << ",\"pending_spikes\":" << value[3]
+         << ",\"inference\":" << value[4] << "}";
+    value += queue_values;
+    file << ",\"rates\":{\"samples_per_second\":" << value[0] << ",\"detected_spikes_per_second\":" << value[1]
+         << ",\"classified_spikes_per_second\":" << value[2] << "}}\n";
+    file.flush();
+}
@@ -0,0 +1,116 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <lsl_cpp.h>
+#include "../../lib/config.h"
+
+// pipeline stages that are timed per chunk (pull and infer on their own threads)
+enum class Stage : int { pull, filter, detect, extract, infer, push, record, lfp, reference };
+constexpr int stage_count = 9;
+const char *stageName(Stage stage);
+
+// Log-linear latency histogram in nanoseconds (HDR style): every power of
+// two is split into 2^sub_bucket_bits linear sub-buckets, so percentiles are
+// accurate to ~3% over the whole 64 bit range. Recording is a single relaxed
+// atomic increment, so any number of threads can record concurrently.
+class LatencyHistogram {
+public:
+    static constexpr int sub_bucket_bits = 5;
+    static constexpr int sub_bucket_count = 1 << sub_bucket_bits;
+    static constexpr int bucket_count = (64 - sub_bucket_bits + 1) * sub_bucket_count;
+
+    struct Snapshot {
+        std::array<uint64_t, bucket_count> counts{};
+        uint64_t total = 0;
+        uint64_t max = 0;
+
+        // latency in nanoseconds below which the fraction q of the values fall
+        [[nodiscard]] uint64_t percentile(double q) const;
+    };
+
+    void record(uint64_t ns);
+    // moves the values recorded since the last drain into snapshot
+    void drain(Snapshot &snapshot);
+
+    static int bucketIndex(uint64_t ns);
+    // representative value (midpoint) of a bucket
+    static uint64_t bucketValue(int index);
+
+private:
+    std::array<std::atomic<uint64_t>, bucket_count> counts{};
+    std::atomic<uint64_t> max{0};
+};
+
+// Latency histograms of all stages plus throughput counters, shared by the
+// ingestion, worker, inference and main threads.
+class PipelineMetrics {
+public:
+    static uint64_t now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // adds the time since start (from now()) to the histogram of a stage
+    void record(Stage stage, uint64_t start) { histograms[static_cast<int>(stage)].record(now() - start); }
+    LatencyHistogram &histogram(Stage stage) { return histograms[static_cast<int>(stage)]; }
+
+    std::atomic<uint64_t> samples{0};
+    std::atomic<uint64_t> detected_spikes{0};
+    std::atomic<uint64_t> classified_spikes{0};
+
+private:
+    std::array<LatencyHistogram, stage_count> histograms;
+};
+
+// queue fill levels sampled by the main loop when a report is due
+struct QueueDepths {
+    size_t ring;
+    size_t ring_high_water;
+    size_t ring_dropped;
+    size_t pending_spikes;      // detected, waiting for their waveform to be complete
+    size_t inference;           // submitted to the classifier, not yet polled
+};
+
+// Periodically drains the histograms into a report of p50/p99/p99.9/max per
+// stage, queue depths and rates. The report is pushed as one sample of the
+// "<stream_name>_metrics" LSL outlet and optionally appended as a JSON line.
+class MetricsReporter {
+public:
+    MetricsReporter(const Config &cfg, PipelineMetrics *metrics);
+
+    // true once metrics.interval seconds of signal have passed since the last report
+    [[nodiscard]] bool due(long sample_idx) const { return interval_samples > 0 and sample_idx >= next_report_idx; }
+    void report(long sample_idx, const QueueDepths &queues);
+
+private:
+    static constexpr int stage_values = 5;     // count, p50, p99, p99.9, max
+    static constexpr int queue_values = 5;
+    static constexpr int rate_values = 3;      // samples/s (wall clock), detected/s, classified/s
+
+    PipelineMetrics *metrics;
+    int sampling_rate;
+    long interval_samples;
+    long next_report_idx;
+    long last_report_idx = 0;
+    uint64_t last_report_time;
+    std::array<uint64_t, 3> last_counters{};
+    LatencyHistogram::Snapshot snapshot;
+    std::vector<double> values;
+
+    std::unique_ptr<lsl::stream_outlet> outlet;
+    std::ofstream file;
+
+    lsl::stream_info setupStreamInfo(const Config &cfg) const;
+    void writeJson(double stream_time);
+};
+
+#endif //METRICS_H
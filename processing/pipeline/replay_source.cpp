@@ -0,0 +1,91 @@
+#include "replay_source.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+#include <type_traits>
+#include <variant>
+#include <xdf.h>
+#include "../../lib/sim_file_io.h"
+
+ReplaySource::ReplaySource(const Config &cfg) : n_channel(cfg.n_channel), loops(std::max(cfg.pipeline.replay_loops, 1)) {
+    const double file_rate = checkFileType(cfg.sim_data_path) ? openXdfFile(cfg.sim_data_path)
+                                                              : openMatFile(cfg.sim_data_path);
+    if (n_rows == 0 or n_file_channel == 0) throw std::runtime_error("Replay file is empty: " + cfg.sim_data_path);
+    if (file_rate < cfg.sampling_rate) {
+        throw std::runtime_error("Replay file " + cfg.sim_data_path + " is sampled at " + std::to_string(std::lround(file_rate)) +
+                                 " Hz, below the pipeline rate of " + std::to_string(cfg.sampling_rate) + " Hz");
+    }
+    step_size = static_cast<std::size_t>(file_rate / cfg.sampling_rate);
+
+    std::cout << "Replaying " << cfg.sim_data_path << ": " << n_rows << " x " << n_file_channel << " at "
+              << file_rate << " Hz, " << loops << " pass(es)" << std::endl;
+}
+
+double ReplaySource::openMatFile(const std::string &path) {
+    matfile.reset(Mat_Open(path.c_str(), MAT_ACC_RDONLY));
+    if (!matfile) {
+        throw std::runtime_error("Failed to open .mat file: " + path);
+    }
+    matvar_t *raw_data = nullptr;
+    matvar_t *spikeVar = handle_mat_file(matfile.get(), &raw_data);
+    mat_var.reset(raw_data);
+    if (spikeVar->data_type != MAT_T_INT16) {
+        throw std::runtime_error("Expected int16 'spike' matrix in " + path);
+    }
+    n_rows = spikeVar->dims[0];
+    n_file_channel = spikeVar->dims[1];
+    mat_data = static_cast<const int16_t *>(spikeVar->data);
+    return 30000;  // Utah Array sampling rate
+}
+
+double ReplaySource::openXdfFile(const std::string &path) {
+    try {
+        Xdf xdf;
+        xdf.load_xdf(path);
+
+        if (xdf.streams.empty()) throw std::runtime_error("no streams");
+        if (xdf.sampleRateMap.empty()) throw std::runtime_error("no nominal sampling rate");
+
+        // converted once, the variant samples are far too slow to read per sample
+        const auto &time_series = xdf.streams[0].time_series;
+        if (time_series.empty()) throw std::runtime_error("the first stream has no channels");
+        n_file_channel = time_series.size();
+        n_rows = time_series[0].size();
+        xdf_data.resize(n_file_channel * n_rows);
+        for (std::size_t c = 0; c < n_file_channel; c++) {
+            if (time_series[c].size() < n_rows) throw std::runtime_error("channels of unequal length");
+            for (std::size_t r = 0; r < n_rows; r++) {
+                xdf_data[c * n_rows + r] = std::visit([](const auto &value) -> double {
+                    if constexpr (std::is_arithmetic_v<std::decay_t<decltype(value)>>) return static_cast<double>(value);
+                    else throw std::runtime_error("string streams cannot be replayed");
+                }, time_series[c][r]);
+            }
+        }
+        return *xdf.sampleRateMap.begin();
+    } catch (const std::exception &ex) {
+        throw std::runtime_error("Error loading XDF file: " + std::string(ex.what()));
+    }
+}
+
+template <typename T>
+std::size_t ReplaySource::read(T *frames, std::size_t max_frames) {
+    std::size_t n_read = 0;
+    while (n_read < max_frames) {
+        if (row >= n_rows) {
+            if (++pass >= loops) break;
+            row = 0;
+        }
+        T *frame = frames + n_read * n_channel;
+        for (int j = 0; j < n_channel; j++) {
+            const std::size_t i = j % n_file_channel;
+            frame[j] = mat_data ? static_cast<T>(mat_data[n_rows * i + row]) : static_cast<T>(xdf_data[n_rows * i + row]);
+        }
+        row += step_size;
+        n_read++;
+    }
+    return n_read;
+}
+
+template std::size_t ReplaySource::read<float>(float *frames, std::size_t max_frames);
+template std::size_t ReplaySource::read<double>(double *frames, std::size_t max_frames);
@@ -0,0 +1,53 @@
+#ifndef REPLAY_SOURCE_H
+#define REPLAY_SOURCE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include <matio.h>
+#include "../../lib/config.h"
+
+// Reads the recording at sim_data_path (.mat Utah snippet or .xdf) for the
+// offline replay mode. Channels and rates are mapped the same way the
+// simulator maps them (channel j reads file channel j % file channels,
+// higher file rates are decimated), so a replay feeds the pipeline exactly
+// the samples it would otherwise receive over LSL, just without pacing.
+// Files recorded below the pipeline sampling rate are rejected.
+class ReplaySource {
+public:
+    explicit ReplaySource(const Config &cfg);
+
+    // copies up to max_frames channel-interleaved samples into frames,
+    // returns 0 once all replay_loops passes are done
+    template <typename T>
+    std::size_t read(T *frames, std::size_t max_frames);
+
+    // samples of one pass at the pipeline sampling rate
+    [[nodiscard]] std::size_t getLength() const { return (n_rows + step_size - 1) / step_size; }
+
+private:
+    int n_channel;
+    int loops;
+    std::size_t step_size = 1;
+
+    struct MatClose { void operator()(mat_t *mat) const { Mat_Close(mat); } };
+    struct MatVarFree { void operator()(matvar_t *var) const { Mat_VarFree(var); } };
+    // released on every exit, including a throwing constructor; the variable before the file
+    std::unique_ptr<mat_t, MatClose> matfile;
+    std::unique_ptr<matvar_t, MatVarFree> mat_var;  // 'rawdata' struct that owns mat_data
+    const int16_t *mat_data = nullptr;  // column-major [n_rows, n_file_channel]
+    std::vector<double> xdf_data;       // channel-major [n_file_channel, n_rows]
+    std::size_t n_rows = 0;
+    std::size_t n_file_channel = 0;
+
+    std::size_t row = 0;
+    int pass = 0;
+
+    // both return the sampling rate of the file
+    double openMatFile(const std::string &path);
+    double openXdfFile(const std::string &path);
+};
+
+#endif //REPLAY_SOURCE_H
@@ -0,0 +1,97 @@
+#include "sharded_engine.h"
+#include <algorithm>
+#include <iostream>
+#include <pthread.h>
+#include "../../lib/simd.h"
+
+template <typename T>
+ShardedEngine<T>::ShardedEngine(const Config &cfg, HistoryBuffer<T> *history, PipelineMetrics *metrics)
+    : n_channel(cfg.n_channel) {
+    const int n_threads = std::clamp(cfg.pipeline.threads, 1, cfg.n_channel);
+
+    // shard boundaries on whole SIMD vectors, so no vector straddles two shards
+    const int shard_size = simd::padded<T>((cfg.n_channel + n_threads - 1) / n_threads);
+    for (int first = 0; first < cfg.n_channel; first += shard_size) {
+        const int count = std::min(shard_size, cfg.n_channel - first);
+        shards.emplace_back(std::make_unique<ChannelShard<T>>(cfg, first, count, history, metrics));
+    }
+
+    if (shards.size() > 1) {
+        const auto n_workers = static_cast<std::ptrdiff_t>(shards.size());
+        start_barrier = std::make_unique<std::barrier<>>(n_workers + 1);
+        done_barrier = std::make_unique<std::barrier<>>(n_workers + 1);
+        const int n_cores = std::max(1u, std::thread::hardware_concurrency());
+        for (int i = 0; i < static_cast<int>(shards.size()); i++) {
+            workers.emplace_back(&ShardedEngine<T>::workerLoop, this, i);
+            if (cfg.pipeline.pin_threads) pinToCore(workers.back(), i % n_cores);
+        }
+    }
+    std::cout << "Processing " << cfg.n_channel << " channels in " << shards.size() << " shard(s)" << std::endl;
+}
+
+template <typename T>
+ShardedEngine<T>::~ShardedEngine() {
+    if (workers.empty()) return;
+    stop = true;
+    start_barrier->arrive_and_wait();
+    for (auto &worker : workers) worker.join();
+}
+
+template <typename T>
+void ShardedEngine<T>::processChunk(const T *chunk, T *filtered, int n_samples, long first_sample_idx) {
+    if (workers.empty()) {
+        shards[0]->processChunk(chunk, filtered, n_samples, n_channel, first_sample_idx);
+        return;
+    }
+    job_chunk = chunk;
+    job_filtered = filtered;
+    job_n_samples = n_samples;
+    job_first_sample_idx = first_sample_idx;
+    start_barrier->arrive_and_wait();
+    done_barrier->arrive_and_wait();
+}
+
+template <typename T>
+bool ShardedEngine<T>::setFilter(const FilterConfig &filter) {
+    bool kept = true;
+    for (auto &shard : shards) kept = shard->setFilter(filter) and kept;
+    return kept;
+}
+
+template <typename T>
+void ShardedEngine<T>::collectSpikeEvents(std::vector<SpikeEvent> &events) const {
+    events.clear();
+    for (const auto &shard : shards) {
+        const auto &shard_events = shard->getSpikeEvents();
+        events.insert(events.end(), shard_events.begin(), shard_events.end());
+    }
+    if (shards.size() > 1) {
+        std::sort(events.begin(), events.end(), [](const SpikeEvent &a, const SpikeEvent &b) {
+            return a.timestamp < b.timestamp or (a.timestamp == b.timestamp and a.channel < b.channel);
+        });
+    }
+}
+
+template <typename T>
+void ShardedEngine<T>::workerLoop(int shard_idx) {
+    ChannelShard<T> &shard = *shards[shard_idx];
+    while (true) {
+        start_barrier->arrive_and_wait();
+        if (stop) return;
+        shard.processChunk(job_chunk, job_filtered, job_n_samples, n_channel, job_first_sample_idx);
+        done_barrier->arrive_and_wait();
+    }
+}
+
+template <typename T>
+void ShardedEngine<T>::pinToCore(std::thread &thread, int core) {
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    CPU_SET(core, &cpuset);
+    if (pthread_setaffinity_np(thread.native_handle(), sizeof(cpu_set_t), &cpuset) != 0) {
+        std::cerr << "Could not pin worker thread to core " << core << std::endl;
+    }
+}
+
+template class ShardedEngine<float>;
+template class ShardedEngine<double>;
@@ -0,0 +1,54 @@
+#ifndef SHARDED_ENGINE_H
+#define SHARDED_ENGINE_H
+
+#include <barrier>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "../../lib/config.h"
+#include "channel_shard.h"
+
+// Splits the channels into one ChannelShard per worker thread. Workers are
+// released once per chunk and the caller waits until every shard finished,
+// so the only synchronisation is two barrier phases per chunk. With a single
+// thread the shard runs inline on the calling thread.
+template <typename T>
+class ShardedEngine {
+public:
+    ShardedEngine(const Config &cfg, HistoryBuffer<T> *history, PipelineMetrics *metrics);
+    ~ShardedEngine();
+
+    ShardedEngine(const ShardedEngine &) = delete;
+    ShardedEngine &operator=(const ShardedEngine &) = delete;
+
+    void processChunk(const T *chunk, T *filtered, int n_samples, long first_sample_idx);
+
+    // replaces the filter of every shard; called between chunks, while the
+    // workers wait at the start barrier. False if the filter state was reset
+    // (ChannelShard::setFilter)
+    bool setFilter(const FilterConfig &filter);
+
+    // spike events of the last chunk of all shards, ordered by (timestamp, channel)
+    void collectSpikeEvents(std::vector<SpikeEvent> &events) const;
+
+    [[nodiscard]] int getShardCount() const { return static_cast<int>(shards.size()); }
+
+private:
+    int n_channel;
+    std::vector<std::unique_ptr<ChannelShard<T>>> shards;
+    std::vector<std::thread> workers;
+    std::unique_ptr<std::barrier<>> start_barrier;
+    std::unique_ptr<std::barrier<>> done_barrier;
+
+    // current job, written before start_barrier and read by the workers after it
+    const T *job_chunk = nullptr;
+    T *job_filtered = nullptr;
+    int job_n_samples = 0;
+    long job_first_sample_idx = 0;
+    bool stop = false;
+
+    void workerLoop(int shard_idx);
+    static void pinToCore(std::thread &thread, int core);
+};
+
+#endif //SHARDED_ENGINE_H
@@ -0,0 +1,101 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include "../../lib/aligned_allocator.h"
+
+// Lock-free single-producer/single-consumer ring of fixed-size frames
+// (one frame = one multi-channel sample). The capacity is rounded up to a
+// power of two, head and tail only ever grow and are masked on access.
+// When the ring is full the producer drops the surplus frames and counts
+// them, it never blocks.
+template <typename T>
+class SpscRing {
+public:
+    SpscRing(std::size_t capacity_frames, std::size_t frame_size)
+        : capacity(std::bit_ceil(std::max<std::size_t>(capacity_frames, 1))), mask(capacity - 1),
+          frame_size(frame_size), data(capacity * frame_size) {}
+
+    // producer side: copies up to n frames and returns how many fit
+    std::size_t write(const T *frames, std::size_t n) {
+        const std::size_t h = head.load(std::memory_order_relaxed);
+        const std::size_t t = tail.load(std::memory_order_acquire);
+        const std::size_t n_write = std::min(n, capacity - (h - t));
+        copyIn(h, frames, n_write);
+        head.store(h + n_write, std::memory_order_release);
+        signal.fetch_add(1, std::memory_order_release);
+        signal.notify_one();
+
+        const std::size_t fill = h + n_write - t;
+        if (fill > high_water_mark.load(std::memory_order_relaxed)) {
+            high_water_mark.store(fill, std::memory_order_relaxed);
+        }
+        if (n_write < n) overflow_frames.fetch_add(n - n_write, std::memory_order_relaxed);
+        return n_write;
+    }
+
+    // consumer side: waits until n frames are available and copies them out.
+    // Returns fewer than n frames only once the ring is closed and drained.
+    std::size_t read(T *frames, std::size_t n) {
+        const std::size_t t = tail.load(std::memory_order_relaxed);
+        std::size_t h;
+        while (true) {
+            const std::uint32_t seq = signal.load(std::memory_order_acquire);
+            h = head.load(std::memory_order_acquire);
+            if (h - t >= n or closed.load(std::memory_order_acquire)) break;
+            signal.wait(seq, std::memory_order_acquire);
+        }
+        const std::size_t n_read = std::min(n, h - t);
+        copyOut(t, frames, n_read);
+        tail.store(t + n_read, std::memory_order_release);
+        return n_read;
+    }
+
+    // wakes up a waiting consumer, remaining frames can still be read
+    void close() {
+        closed.store(true, std::memory_order_release);
+        signal.fetch_add(1, std::memory_order_release);
+        signal.notify_all();
+    }
+
+    [[nodiscard]] std::size_t size() const {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+    }
+    [[nodiscard]] std::size_t getCapacity() const { return capacity; }
+    [[nodiscard]] std::size_t getHighWaterMark() const { return high_water_mark.load(std::memory_order_relaxed); }
+    [[nodiscard]] std::size_t getOverflowCount() const { return overflow_frames.load(std::memory_order_relaxed); }
+
+private:
+    const std::size_t capacity;
+    const std::size_t mask;
+    const std::size_t frame_size;
+    aligned_vector<T> data;
+
+    // producer and consumer indices on separate cache lines
+    alignas(64) std::atomic<std::size_t> head{0};
+    alignas(64) std::atomic<std::size_t> tail{0};
+    alignas(64) std::atomic<std::size_t> high_water_mark{0};
+    std::atomic<std::size_t> overflow_frames{0};
+    std::atomic<bool> closed{false};
+    std::atomic<std::uint32_t> signal{0};   // bumped on every write, the consumer sleeps on it
+
+    void copyIn(std::size_t pos, const T *src, std::size_t n) {
+        const std::size_t first = std::min(n, capacity - (pos & mask));
+        std::memcpy(&data[(pos & mask) * frame_size], src, first * frame_size * sizeof(T));
+        std::memcpy(&data[0], src + first * frame_size, (n - first) * frame_size * sizeof(T));
+    }
+
+    void copyOut(std::size_t pos, T *dst, std::size_t n) const {
+        const std::size_t first = std::min(n, capacity - (pos & mask));
+        std::memcpy(dst, &data[(pos & mask) * frame_size], first * frame_size * sizeof(T));
+        std::memcpy(dst + first * frame_size, &data[0], (n - first) * frame_size * sizeof(T));
+    }
+};
+
+#endif //SPSC_RING_H
@@ -1,37 +1,134 @@
 #include "processing.h"
 #include <yaml-cpp/yaml.h>
+#include <fstream>
 #include <torch/script.h>
-#include "filter/FIR_Filter.h"
-#include "filter/IIR_Filter.h"
 #include "../lib/xdf_writer_template.h"
 
-Processing::Processing(const std::string &config_path){
+Processing::Processing(const std::string &config_path) : config_path(config_path) {
     loadConfig(config_path);
 }
 
 
 void Processing::run() {
+    const lsl::channel_format_t format = sampleFormat();
     loadModel();
-    generateFilters();
-    generateRunningStdDev();
-    auto inlet = setupLSLInlet();
+    generateLfpFilters();
+    std::unique_ptr<lsl::stream_inlet> inlet;
+    std::unique_ptr<ReplaySource> replay;
+    if (cfg.pipeline.source == "replay") {
+        replay = std::make_unique<ReplaySource>(cfg);
+    } else if (cfg.pipeline.source == "lsl") {
+        inlet = setupLSLInlet();
+    } else {
+        throw std::runtime_error("Unsupported pipeline.source: " + cfg.pipeline.source);
+    }
     auto outlet = setupLSLOutlet();
     auto spike_outlet = setupLSLSpikeOutlet();
-    processData(&inlet, &outlet, &spike_outlet);
+    auto lfp_outlet = setupLSLLfpOutlet();
+    if (format == lsl::cf_float32) {
+        processData<float>(inlet.get(), replay.get(), &outlet, &spike_outlet, lfp_outlet.get());
+    } else {
+        processData<double>(inlet.get(), replay.get(), &outlet, &spike_outlet, lfp_outlet.get());
+    }
+}
+
+
+template <typename T>
+void Processing::receiveData(std::stop_token stop, lsl::stream_inlet *inlet, SpscRing<T> *ring) {
+    const int chunk_size = cfg.buffer.chunk_size;
+    std::vector<T> chunk(chunk_size * cfg.n_channel, 0);
+    std::vector<double> chunk_timestamps(chunk_size, 0);
+    try {
+        while(not stop.stop_requested()) {
+            // short timeout, so a stop request is noticed while the stream is idle
+            const uint64_t start = PipelineMetrics::now();
+            const size_t n_samples = inlet->pull_chunk_multiplexed(chunk.data(), chunk_timestamps.data(),
+                                                                   chunk.size(), chunk_timestamps.size(),
+                                                                   0.2) / cfg.n_channel;
+            if(n_samples > 0) metrics.record(Stage::pull, start);
+            ring->write(chunk.data(), n_samples);
+        }
+    } catch (...) {
+        receive_error = std::current_exception();
+    }
+    ring->close();
+}
+
+
+template <typename T>
+void Processing::replayData(std::stop_token stop, ReplaySource *replay, SpscRing<T> *ring) {
+    const int chunk_size = cfg.buffer.chunk_size;
+    std::vector<T> chunk(chunk_size * cfg.n_channel, 0);
+    try {
+        while(not stop.stop_requested()) {
+            const uint64_t start = PipelineMetrics::now();
+            const size_t n_samples = replay->read(chunk.data(), chunk_size);
+            if(n_samples == 0) break;
+            metrics.record(Stage::pull, start);
+
+            // as fast as possible but lossless: wait for the pipeline instead of dropping samples
+            while(ring->getCapacity() - ring->size() < n_samples and not stop.stop_requested()) {
+                std::this_thread::yield();
+            }
+            ring->write(chunk.data(), n_samples);
+        }
+    } catch (...) {
+        receive_error = std::current_exception();
+    }
+    ring->close();
 }
 
 
-void Processing::processData(lsl::stream_inlet *inlet, lsl::stream_outlet *outlet, lsl::stream_outlet *spike_outlet ) {
-    std::vector<double> sample(cfg.n_channel,0);
-    std::vector<double> filtered_values(cfg.n_channel, 0);
-    std::vector<double> outputSample(2 * cfg.n_channel, 0);
-    std::vector<double> spike_outputSample(cfg.model.input_size + 1, 0);
+template <typename T>
+void Processing::processData(lsl::stream_inlet *inlet, ReplaySource *replay, lsl::stream_outlet *outlet, lsl::stream_outlet *spike_outlet,
+                             lsl::stream_outlet *lfp_outlet) {
+    const int chunk_size = cfg.buffer.chunk_size;
+    std::vector<T> chunk(chunk_size * cfg.n_channel, 0);                    // channel-interleaved input block
+    std::vector<T> referenced_chunk;                                        // chunk after CAR / CMR, empty without
+    std::vector<T> filtered_chunk(chunk_size * cfg.n_channel, 0);
+    std::vector<T> output_chunk(2 * chunk_size * cfg.n_channel, 0);         // raw and filtered, interleaved
+    std::vector<float> spike_output_chunk;
+    std::vector<T> lfp_chunk;                                               // decimated LFP samples of one chunk
+    std::vector<SpikeEvent> chunk_spike_events;
+    std::vector<double> record_timestamps;
+    record_timestamps.reserve(chunk_size);
     long sampleIdx = 0;
     long sim_seconds = 0;
     double exact_ts = 0.0;
 
-    uint8_t spike_cut_out_len = cfg.model.input_size;  // input size of classifier model
-    window.reserve(cfg.buffer.window_size);
+    const int spike_cut_out_len = cfg.model.input_size;  // input size of classifier model
+    std::vector<T> waveform(spike_cut_out_len, 0);
+    // waveforms are centred on the negative peak within align_window of the crossing
+    WaveformAligner<T> aligner(spike_cut_out_len, static_cast<int>(std::lround(cfg.detector.align_window * cfg.sampling_rate)),
+                               parseInterpolation(cfg.detector.interpolation));
+
+    // filtered history of buffer.size windows for waveform extraction
+    HistoryBuffer<T> history(cfg.n_channel, static_cast<size_t>(cfg.buffer.size) * cfg.buffer.window_size);
+    ShardedEngine<T> engine(cfg, &history, &metrics);
+    MetricsReporter reporter(cfg, &metrics);
+    ConfigWatcher watcher(config_path, cfg);
+
+    // re-referencing feeds the filters only, the raw outputs, the recording and the LFP keep the input
+    const ReferenceMode reference_mode = parseReferenceMode(cfg.reference.mode);
+    std::unique_ptr<CommonReference<T>> reference;
+    if(reference_mode != ReferenceMode::none) {
+        reference = std::make_unique<CommonReference<T>>(cfg.n_channel, referenceGroups(), reference_mode,
+                                                        cfg.reference.resolution);
+        referenced_chunk.resize(chunk.size());
+        std::cout << "Re-referencing " << cfg.reference.mode << " over " << reference->getGroupCount() << " electrode groups" << std::endl;
+    }
+
+    // detected events for offline evaluation of the detectors, one "sample,channel" line each
+    std::ofstream events_file;
+    if(!cfg.detector.events_path.empty()) {
+        events_file.open(cfg.detector.events_path);
+        if(!events_file) throw std::runtime_error("Cannot open events file: " + cfg.detector.events_path);
+    }
+
+    // spikes are classified in batches on the inference thread, a batch is submitted
+    // once it is full or one window after its first spike
+    SpikeBatch spike_batch = classifier->acquire();
+    long batch_start_idx = 0;
 
     // prepare recording of data
     if(cfg.recording.do_record) {
@@ -39,89 +136,183 @@ void Processing::processData(lsl::stream_inlet *inlet, lsl::stream_outlet *outle
         write_header(xdf_writer.get(), cfg);
     }
 
+    // LSL ingestion runs on its own thread and hands samples over through a lock-free ring,
+    // so slow inference or disk writes are absorbed by the ring instead of stalling the inlet.
+    // read() waits for a whole chunk, so the ring holds at least two of them
+    SpscRing<T> ring(std::max(cfg.buffer.ring_size, 2 * chunk_size), cfg.n_channel);
+    std::jthread receiver([this, inlet, replay, &ring](std::stop_token stop) {
+        if(replay) replayData<T>(stop, replay, &ring);
+        else receiveData<T>(stop, inlet, &ring);
+    });
+
     // track the time for real time factor estimates
     auto start = std::chrono::high_resolution_clock::now();
+    const auto run_start = start;
     int spikes_processed = 0;
     while(true) {
-        inlet->pull_sample(sample);
-
-        // filtering and spike detection
-        for(int channel = 0; channel < sample.size(); channel++) {
-            filtered_values[channel] = biQfilters[channel]->process(sample[channel]);
-            runningStdDev_calcs[channel]->update(filtered_values[channel]);
-
-            detect_spikes(filtered_values[channel], sampleIdx, channel);
+        // blocks until a full chunk has arrived
+        const size_t n_samples = ring.read(chunk.data(), chunk_size);
+        if(n_samples == 0) {
+            if(receive_error) std::rethrow_exception(receive_error);
+            break;
         }
-        window.emplace_back(sampleIdx, filtered_values);
-
-        // handle spike events
-        if(window.size() % cfg.buffer.window_size == 0) {
-            for(auto &spike_event : spike_events) {
-                int pos_in_win = spike_event.timestamp % cfg.buffer.window_size;
-                int frame_start = int(pos_in_win) - int(spike_cut_out_len)/2;
-                int frame_end = int(pos_in_win) + int(spike_cut_out_len)/2;
-
-                // extract waveform
-                auto waveform = extract_waveform(&spike_event,frame_start, frame_end, pos_in_win);
-
-                // do inference
-                if(!waveform.empty()) {
-                    torch::Tensor input = torch::tensor(waveform);
-                    input = input.view({1,-1});
-                    auto output = model.forward({input});
-                    // std::cout <<"Spike in Channel: " <<spike_event.channel << ", Model output: "<< output << std::endl;
-                    spike_outputSample[0] = spike_event.channel;
-                    for(int i = 1; i <= cfg.model.input_size; i++) {
-                        spike_outputSample[i] = waveform[i-1];
-                    }
-                    spike_outlet->push_sample(spike_outputSample);
-                    spikes_processed++;
-                    waveform.clear();
-                }
-                spike_events.pop_front();
-            }
+        const long chunk_start_idx = sampleIdx;
+
+        const T *filter_input = chunk.data();
+        if(reference) {
+            const uint64_t reference_start = PipelineMetrics::now();
+            reference->processChunk(chunk.data(), referenced_chunk.data(), static_cast<int>(n_samples));
+            metrics.record(Stage::reference, reference_start);
+            filter_input = referenced_chunk.data();
         }
 
-        // adjust buffered data
-        if(sampleIdx % cfg.buffer.window_size == 0 and sampleIdx > 0){
-            if(window_buffer.size() >= cfg.buffer.size) window_buffer.pop_front();
-            window_buffer.emplace_back(0,window);
-            window.clear();
+        // filtering and spike detection of the whole chunk, sharded over the worker threads
+        engine.processChunk(filter_input, filtered_chunk.data(), n_samples, chunk_start_idx);
+        engine.collectSpikeEvents(chunk_spike_events);
+        spike_events.insert(spike_events.end(), chunk_spike_events.begin(), chunk_spike_events.end());
+        if(events_file.is_open()) {
+            for(const SpikeEvent &event : chunk_spike_events) events_file << event.timestamp << ',' << event.channel << '\n';
         }
+        sampleIdx += n_samples;
+        metrics.samples.fetch_add(n_samples, std::memory_order_relaxed);
+        metrics.detected_spikes.fetch_add(chunk_spike_events.size(), std::memory_order_relaxed);
+
+        // extract spike events whose waveform is completely in the history by now
+        uint64_t stage_start = PipelineMetrics::now();
+        while(!spike_events.empty() and spike_events.front().timestamp + aligner.getLookahead() <= sampleIdx) {
+            const SpikeEvent &spike_event = spike_events.front();
+            if(aligner.extract(history, spike_event, sampleIdx, waveform.data())) {
+                if(spike_batch.size() == 0) batch_start_idx = sampleIdx;
+                spike_batch.events.push_back(spike_event);
+                spike_batch.waveforms.insert(spike_batch.waveforms.end(), waveform.begin(), waveform.end());
+            }
+            spike_events.pop_front();
 
-        // prepare samples for output stream
-        for(int i=0; i<cfg.n_channel; i++) {
-            outputSample[2*i] = sample[i];
-            outputSample[2*i+1] = filtered_values[i];
+            if(spike_batch.size() >= static_cast<size_t>(cfg.model.batch_size)) {
+                classifier->submit(std::move(spike_batch));
+                spike_batch = classifier->acquire();
+            }
         }
-        outlet->push_sample(outputSample);
+        if(spike_batch.size() > 0 and sampleIdx - batch_start_idx >= cfg.buffer.window_size) {
+            classifier->submit(std::move(spike_batch));
+            spike_batch = classifier->acquire();
+        }
+        metrics.record(Stage::extract, stage_start);
+
+        stage_start = PipelineMetrics::now();
+        const int spikes_classified = pushClassifiedSpikes(spike_outlet, spike_output_chunk);
+        spikes_processed += spikes_classified;
+        metrics.classified_spikes.fetch_add(spikes_classified, std::memory_order_relaxed);
+
+        for(size_t s = 0; s < n_samples; s++) {
+            const T *sample = &chunk[s * cfg.n_channel];
+            const T *filtered_values = &filtered_chunk[s * cfg.n_channel];
+            const long idx = chunk_start_idx + static_cast<long>(s);
+
+            // prepare samples for output stream
+            T *outputSample = &output_chunk[2 * s * cfg.n_channel];
+            for(int i=0; i<cfg.n_channel; i++) {
+                outputSample[2*i] = sample[i];
+                outputSample[2*i+1] = filtered_values[i];
+            }
 
-        // log every second
-        if (sampleIdx % cfg.sampling_rate == 0) {
-            auto end = std::chrono::high_resolution_clock::now();
-            auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
-            start = end;
+            // log every second
+            if (idx % cfg.sampling_rate == 0) {
+                auto end = std::chrono::high_resolution_clock::now();
+                auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+                start = end;
 
-            std::cout << "P: Time passed: " << ++sim_seconds << "s (computed in: "<< duration.count() << "us), Spikes Processed: " << spikes_processed <<std::endl;
-            //std::cout << "Std Dev: " << runningStdDev_calcs[0]->getStandardDeviation();
-            //std::cout << std::endl;
+                std::cout << "P: Time passed: " << ++sim_seconds << "s (computed in: "<< duration.count() << "us), Spikes Processed: " << spikes_processed
+                          << ", Ring: " << ring.size() << "/" << ring.getCapacity() << " (high water: " << ring.getHighWaterMark()
+                          << ", dropped: " << ring.getOverflowCount() << ")" << std::endl;
+            }
+        }
+        outlet->push_chunk_multiplexed(output_chunk.data(), 2 * n_samples * cfg.n_channel);
+        metrics.record(Stage::push, stage_start);
+
+        if(lfp_outlet) {
+            stage_start = PipelineMetrics::now();
+            processLfp(chunk.data(), n_samples, lfp_outlet, lfp_chunk);
+            metrics.record(Stage::lfp, stage_start);
         }
 
         // handle recording of neural device
         if(cfg.recording.do_record){
+            stage_start = PipelineMetrics::now();
+            const long last_idx = cfg.recording.duration * cfg.sampling_rate;
+            record_timestamps.clear();
             // seconds instead of sample count
-            exact_ts = (static_cast<double>(sampleIdx)/cfg.sampling_rate);
-            if (sampleIdx <= cfg.recording.duration * cfg.sampling_rate) {
-                xdf_writer->write_data_chunk(0, {exact_ts}, sample, cfg.n_channel);
+            for(long idx = chunk_start_idx; idx < sampleIdx and idx <= last_idx; idx++) {
+                record_timestamps.push_back(static_cast<double>(idx)/cfg.sampling_rate);
             }
-            if (sampleIdx == cfg.recording.duration * cfg.sampling_rate) {
-                write_footer(xdf_writer.get(), cfg,exact_ts, sampleIdx);
+            xdf_writer->write_data_chunk(0, record_timestamps, chunk.data(),
+                                         record_timestamps.size(), cfg.n_channel);
+            if (last_idx < sampleIdx) {
+                exact_ts = static_cast<double>(last_idx)/cfg.sampling_rate;
+                write_footer(xdf_writer.get(), cfg,exact_ts, last_idx);
                 cfg.recording.do_record = false;
             }
+            metrics.record(Stage::record, stage_start);
+        }
+
+        if(reporter.due(sampleIdx)) {
+            reporter.report(sampleIdx, {ring.size(), ring.getHighWaterMark(), ring.getOverflowCount(),
+                                        spike_events.size(), classifier->pending()});
+        }
+
+        // retuning happens between chunks, the next chunk already runs through the new filter
+        if(watcher.due(sampleIdx)) {
+            if(auto new_cfg = watcher.poll(sampleIdx)) retuneFilter(engine, *new_cfg);
+        }
+    }
+
+    if(replay) {
+        // the recording is exhausted: classify what is left and report the throughput
+        if(spike_batch.size() > 0) classifier->submit(std::move(spike_batch));
+        while(classifier->pending() > 0) {
+            spikes_processed += pushClassifiedSpikes(spike_outlet, spike_output_chunk);
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
         }
+        const auto elapsed = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - run_start).count();
+        const double signal_seconds = static_cast<double>(sampleIdx) / cfg.sampling_rate;
+        std::cout << "R: Replayed " << sampleIdx << " samples x " << cfg.n_channel << " channels ("
+                  << signal_seconds << "s) in " << elapsed << "s: "
+                  << static_cast<double>(sampleIdx) * cfg.n_channel / elapsed << " samples*channels/s ("
+                  << signal_seconds / elapsed << "x real time), Spikes Processed: " << spikes_processed << std::endl;
+    }
+}
 
-        sampleIdx++;
+
+template <typename T>
+void Processing::processLfp(const T *chunk, size_t n_samples, lsl::stream_outlet *lfp_outlet, std::vector<T> &lfp_chunk) {
+    // all channels share the decimation phase, so they complete the same number of samples
+    const int decimation = lfp_filters[0]->getDecimation();
+    lfp_chunk.resize((n_samples / decimation + 1) * cfg.n_channel);
+    int n_out = 0;
+    for(int i = 0; i < cfg.n_channel; i++) {
+        n_out = lfp_filters[i]->processBlock(chunk + i, static_cast<int>(n_samples), cfg.n_channel, lfp_chunk.data() + i, cfg.n_channel);
     }
+    lfp_chunk.resize(static_cast<size_t>(n_out) * cfg.n_channel);
+    if(!lfp_chunk.empty()) lfp_outlet->push_chunk_multiplexed(lfp_chunk.data(), lfp_chunk.size());
+}
+
+template <typename T>
+void Processing::retuneFilter(ShardedEngine<T> &engine, const Config &new_cfg) {
+    // only the filter section is applied while running, everything else needs a restart
+    if(new_cfg.filter == cfg.filter) return;
+    const auto start = std::chrono::high_resolution_clock::now();
+    bool kept;
+    try {
+        kept = engine.setFilter(new_cfg.filter);
+    } catch(const std::exception &e) {
+        std::cerr << "Keeping the current filter, new settings rejected: " << e.what() << std::endl;
+        return;
+    }
+    cfg.filter = new_cfg.filter;
+    const auto duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start);
+    std::cout << "Retuned filter to " << cfg.filter.filter_class << " " << cfg.filter.type << " " << cfg.filter.lowcut
+              << "-" << cfg.filter.highcut << " Hz (order " << cfg.filter.order << ") in " << duration.count() / 1000.0 << " ms"
+              << (kept ? "" : ", filter state reset, expect a transient") << std::endl;
 }
 
 
@@ -135,111 +326,64 @@ void Processing::loadConfig(const std::string &config_path) {
 }
 
 void Processing::loadModel() {
-    // model path should be part of the config
-    std::string modelpath = "../model.pt";
-    modelpath = cfg.model.path;
-    model = torch::jit::load(modelpath);
+    classifier = std::make_unique<SpikeClassifier>(cfg.model.path, cfg.model.input_size, &metrics);
     std::cout << "Loaded Torch Model successfully" << std::endl;
-
 }
 
-
-void Processing::generateFilters() {
-    filters.reserve(cfg.n_channel);
-    for (int i=0;i<cfg.n_channel;i++) {
-        if (cfg.filter.filter_class == "iir") {
-            filters.emplace_back(std::make_unique<IIR_Filter>(cfg.filter.order, cfg.sampling_rate,
-                                                                "double", cfg.filter.type,
-                                                                cfg.filter.lowcut, cfg.filter.highcut));
-        }else {
-            filters.emplace_back(std::make_unique<FIR_Filter>(cfg.filter.order, cfg.sampling_rate,
-                                                                "double", cfg.filter.type,
-                                                                cfg.filter.lowcut, cfg.filter.highcut));
+int Processing::pushClassifiedSpikes(lsl::stream_outlet *spike_outlet, std::vector<float> &spike_output_chunk) {
+    classified_batches.clear();
+    if(classifier->poll(classified_batches) == 0) return 0;
+
+    int n_spikes = 0;
+    for(auto &batch : classified_batches) {
+        // one row per spike: channel followed by the waveform
+        spike_output_chunk.resize(batch.size() * (cfg.model.input_size + 1));
+        for(size_t i = 0; i < batch.size(); i++) {
+            float *row = &spike_output_chunk[i * (cfg.model.input_size + 1)];
+            row[0] = static_cast<float>(batch.events[i].channel);
+            std::copy_n(&batch.waveforms[i * cfg.model.input_size], cfg.model.input_size, row + 1);
         }
+        spike_outlet->push_chunk_multiplexed(spike_output_chunk.data(), spike_output_chunk.size());
+        n_spikes += static_cast<int>(batch.size());
+        classifier->release(std::move(batch));
     }
-    biQfilters.reserve(cfg.n_channel);
-    for(int i = 0; i< cfg.n_channel; i++) {
-        biQfilters.emplace_back(new Biquad(2,((cfg.filter.highcut + cfg.filter.lowcut)/2)/cfg.sampling_rate, 0.707,0));
-    }
+    return n_spikes;
 }
 
 
-void Processing::generateRunningStdDev() {
-    runningStdDev_calcs.reserve(cfg.n_channel);
-    for(int i = 0; i< cfg.n_channel; i++) {
-        runningStdDev_calcs.emplace_back(new OnlineStdDev());
-    }
-}
-
-void Processing::detect_spikes(double filtered_value, uint32_t sampleIdx, int channel) {
-    // save last spikes occurrence in given channel
-    static std::vector<uint32_t> last_spike_events(cfg.n_channel);
-
-    // After 5 seconds, if the value deviates much from the current standard deviation, a spike is detected
-    if(filtered_value < -5 * runningStdDev_calcs[channel]->getStandardDeviation() and sampleIdx > 5*cfg.sampling_rate) {
-
-        // if the spike is at least 10 samples after the last spike in this channel
-        if(sampleIdx > last_spike_events[channel]+10) {
-            spike_events.push_back(SpikeEvent(channel,sampleIdx));
-            last_spike_events[channel] = sampleIdx;
-
-        }
-    }
+std::vector<std::vector<int>> Processing::referenceGroups() const {
+    if(cfg.use_layout) return layoutGroups(readLayout(cfg.mapping_path), cfg.n_channel, cfg.reference.block);
+    std::vector<int> all(cfg.n_channel);
+    for(int channel = 0; channel < cfg.n_channel; channel++) all[channel] = channel;
+    return {all};
 }
 
-std::vector<double> Processing::extract_waveform(SpikeEvent *spike_event,int frame_start, int frame_end, int pos_in_win) {
-
-    std::vector<double> spike_waveform;
-    static int window_size = cfg.buffer.window_size;
-    static int spike_cut_out_len = cfg.model.input_size;
-
-    // trivial case when the frame is completely within the window
-    if(frame_start >= 0 and frame_end <= window_size - spike_cut_out_len/2) {
-        for (int i=0; i < cfg.model.input_size; i++) {
-            spike_waveform.emplace_back(window[pos_in_win+i-spike_cut_out_len/2].sample[spike_event->channel]);
-        }
-        return spike_waveform;
-    }
-
-    // frame is at the start of the current frame
-    if(frame_start < 0) {
-        auto prev_window = window_buffer.back();
-        for (int i=abs(frame_start); i > 0; i--) {
-            spike_waveform.emplace_back(prev_window.data[window_size-i].sample[spike_event->channel]);
-        }
-        for (int i=0; i < spike_cut_out_len+frame_start; i++) {
-            spike_waveform.emplace_back(window[i].sample[spike_event->channel]);
-        }
-        return spike_waveform;
+void Processing::generateLfpFilters() {
+    if (!cfg.lfp.enabled) return;
+    if (cfg.lfp.rate <= 0 or cfg.sampling_rate % cfg.lfp.rate != 0) {
+        throw std::runtime_error("lfp.rate must divide sampling_rate: " + std::to_string(cfg.lfp.rate));
     }
-
-    // if the spikeEvent is from the end previous window
-    if(spike_event->isOld == true) {
-        auto prev_window = window_buffer.back();
-        // frame start is in the old window
-        for (int i=frame_start; i < window_size; i++) {
-            spike_waveform.emplace_back(prev_window.data[i].sample[spike_event->channel]);
-        }
-        // frame end is in the current window
-        for(int i=0; i <abs(window_size-frame_end); i++) {
-            spike_waveform.emplace_back(window[i].sample[spike_event->channel]);
-        }
-        return spike_waveform;
+    const int decimation = cfg.sampling_rate / cfg.lfp.rate;
+    lfp_filters.reserve(cfg.n_channel);
+    for (int i=0;i<cfg.n_channel;i++) {
+        lfp_filters.emplace_back(std::make_unique<Decimating_FIR_Filter>(cfg.lfp.taps, cfg.sampling_rate,
+                                                                          BandType::lowpass,
+                                                                          cfg.lfp.cutoff, cfg.lfp.cutoff,
+                                                                          decimation));
     }
+}
 
-    // if the spike event is at the end of the current window + not from the previous window
-    if(frame_end>=window_size and spike_event->isOld == false) {
-        spike_event->isOld = true,
-        spike_events.push_back(*spike_event);
-    }
 
-    return spike_waveform;
+lsl::channel_format_t Processing::sampleFormat() const {
+    if (cfg.pipeline.sample_type == "float") return lsl::cf_float32;
+    if (cfg.pipeline.sample_type == "double") return lsl::cf_double64;
+    throw std::runtime_error("Unsupported pipeline.sample_type: " + cfg.pipeline.sample_type);
 }
 
-lsl::stream_inlet Processing::setupLSLInlet() const {
+std::unique_ptr<lsl::stream_inlet> Processing::setupLSLInlet() const {
     std::cout << "Looking for an LSL stream..." << std::endl;
     std::vector<lsl::stream_info> streams = lsl::resolve_stream("name", cfg.stream_name);
-    lsl::stream_inlet inlet(streams[0]);
+    auto inlet = std::make_unique<lsl::stream_inlet>(streams[0]);
     std::cout << "Connected to stream: " << streams[0].name() << std::endl;
     std::cout << "Datatype: " << streams[0].channel_format() << std::endl;
     return inlet;
@@ -249,19 +393,28 @@ lsl::stream_outlet Processing::setupLSLOutlet() const{
     int n_out_channel = 2 * cfg.n_channel;
     std::string name = cfg.stream_name + "_filtered";
 
-    lsl::stream_info info(name, "EEG", n_out_channel, cfg.sampling_rate, lsl::cf_int16, "3423421filtered");
+    lsl::stream_info info(name, "EEG", n_out_channel, cfg.sampling_rate, sampleFormat(), "3423421filtered");
     lsl::stream_outlet outlet(info);
     std::cout << "Created LSL Outlet for raw and filtered data!" << std::endl;
     return outlet;
 }
 
 lsl::stream_outlet Processing::setupLSLSpikeOutlet() const{
-    lsl::stream_info spike_info("spikes", "EEG", cfg.model.input_size + 1, lsl::IRREGULAR_RATE, lsl::cf_int16, "3113208");
+    // channel index followed by the float32 waveform that was fed to the classifier
+    lsl::stream_info spike_info("spikes", "EEG", cfg.model.input_size + 1, lsl::IRREGULAR_RATE, lsl::cf_float32, "3113208");
     lsl::stream_outlet spike_outlet(spike_info);
     std::cout << "Created LSL Outlet for detected spikes" << std::endl;
     return spike_outlet;
 }
 
+std::unique_ptr<lsl::stream_outlet> Processing::setupLSLLfpOutlet() const {
+    if (lfp_filters.empty()) return nullptr;
+    lsl::stream_info info(cfg.stream_name + "_lfp", "EEG", cfg.n_channel, cfg.lfp.rate, sampleFormat(), "3423421lfp");
+    auto outlet = std::make_unique<lsl::stream_outlet>(info);
+    std::cout << "Created LSL Outlet for LFP data at " << cfg.lfp.rate << " Hz" << std::endl;
+    return outlet;
+}
+
 std::unique_ptr<XDFWriter> Processing::load_xdf_writer() const {
     std::string filename = cfg.recording.path + "/" + cfg.recording.file_name;
     auto writer = std::make_unique<XDFWriter>(filename);
@@ -1,58 +1,69 @@
 #ifndef PROCESSING_H
 #define PROCESSING_H
 #include <string>
+#include <deque>
+#include <exception>
+#include <thread>
 
 #include <lsl_cpp.h>
 #include "../lib/config.h"
 #include <torch/torch.h>
 
 #include "../lib/xdfwriter.h"
-#include "filter/Filter.h"
-#include "filter/Biquad.h"
-#include "spikesorting/online_std_dev.h"
-
-struct SpikeEvent {
-    int channel;
-    long timestamp;
-    bool isOld = false;
-};
-
-struct SampleData {
-    long timestamp;
-    std::vector<double> sample;
-};
-
-struct Window {
-    int idx;
-    std::vector<SampleData> data;
-};
+#include "filter/CommonReference.h"
+#include "filter/Decimating_FIR_Filter.h"
+#include "pipeline/config_watcher.h"
+#include "pipeline/history_buffer.h"
+#include "pipeline/metrics.h"
+#include "pipeline/replay_source.h"
+#include "pipeline/sharded_engine.h"
+#include "pipeline/spsc_ring.h"
+#include "spikesorting/spike_classifier.h"
+#include "spikesorting/spike_event.h"
+#include "spikesorting/waveform_aligner.h"
 
 class Processing {
 public:
     explicit Processing(const std::string &config_path);
     void run();
 private:
+    std::string config_path;
     Config cfg;
-    torch::jit::script::Module model;
-    std::vector<std::unique_ptr<Filter>> filters;
-    std::vector<std::unique_ptr<Biquad>> biQfilters;
-    std::vector<std::unique_ptr<OnlineStdDev>> runningStdDev_calcs;
-    std::vector<std::pair<int,std::vector<double>>> waveforms;
+    PipelineMetrics metrics;
+    std::unique_ptr<SpikeClassifier> classifier;
+    std::vector<SpikeBatch> classified_batches;
+    std::vector<std::unique_ptr<Decimating_FIR_Filter>> lfp_filters;     // one per channel, empty if lfp is disabled
+
+    std::exception_ptr receive_error;
 
     std::unique_ptr<XDFWriter> xdf_writer;
     std::deque<SpikeEvent> spike_events;
-    std::vector<SampleData> window;
-    std::deque<Window> window_buffer;
     void loadConfig(const std::string &config_path);
     void loadModel();
-    void generateFilters();
-    void generateRunningStdDev();
-    void processData(lsl::stream_inlet *inlet, lsl::stream_outlet *outlet, lsl::stream_outlet *spike_outlet);
-    void detect_spikes(double filtered_value, uint32_t sampleIdx, int channel);
-    std::vector<double> extract_waveform(SpikeEvent *spike_event, int frame_start, int frame_end, int pos_in_win);
-    lsl::stream_inlet setupLSLInlet() const;
+    void generateLfpFilters();
+    // electrode groups for re-referencing: the layout blocks with use_layout, otherwise all channels
+    std::vector<std::vector<int>> referenceGroups() const;
+    // the pipeline from the inlet to the model input runs on the sample type T (float or double)
+    template <typename T>
+    void receiveData(std::stop_token stop, lsl::stream_inlet *inlet, SpscRing<T> *ring);
+    template <typename T>
+    void replayData(std::stop_token stop, ReplaySource *replay, SpscRing<T> *ring);
+    // samples come either from the LSL inlet or, in replay mode, from the replay source
+    template <typename T>
+    void processData(lsl::stream_inlet *inlet, ReplaySource *replay, lsl::stream_outlet *outlet, lsl::stream_outlet *spike_outlet,
+                     lsl::stream_outlet *lfp_outlet);
+    // applies the filter section of a re-read config to the running engine
+    template <typename T>
+    void retuneFilter(ShardedEngine<T> &engine, const Config &new_cfg);
+    // runs the raw chunk through the decimating LFP filters and pushes the completed LFP samples
+    template <typename T>
+    void processLfp(const T *chunk, size_t n_samples, lsl::stream_outlet *lfp_outlet, std::vector<T> &lfp_chunk);
+    int pushClassifiedSpikes(lsl::stream_outlet *spike_outlet, std::vector<float> &spike_output_chunk);
+    lsl::channel_format_t sampleFormat() const;
+    std::unique_ptr<lsl::stream_inlet> setupLSLInlet() const;
     lsl::stream_outlet setupLSLOutlet() const;
     lsl::stream_outlet setupLSLSpikeOutlet() const;
+    std::unique_ptr<lsl::stream_outlet> setupLSLLfpOutlet() const;
     std::unique_ptr<XDFWriter> load_xdf_writer() const;
 };
 #endif //PROCESSING_H
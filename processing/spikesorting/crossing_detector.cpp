@@ -0,0 +1,68 @@
+#include "crossing_detector.h"
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+
+CrossingDetector::CrossingDetector(int n_channel, int lanes, int max_samples, int first_channel)
+    : lanes(lanes), n_blocks((n_channel + lanes - 1) / lanes), max_samples(max_samples), first_channel(first_channel),
+      n_events(0) {
+    if (lanes < 1 or lanes > 32) throw std::invalid_argument("CrossingDetector: 1 to 32 channels per mask word");
+    countdown.assign(static_cast<size_t>(n_blocks) * countdown_bits, 0);
+    fired.assign(static_cast<size_t>(max_samples) * n_blocks, 0);
+    // spikes of a channel are more than refractory_samples apart
+    const int max_per_channel = (max_samples + refractory_samples) / (refractory_samples + 1);
+    events.resize(static_cast<size_t>(max_per_channel) * n_channel);
+}
+
+void CrossingDetector::process(const uint32_t *crossings, int n_samples, long first_sample_idx, long quiet_until) {
+    if (n_samples > max_samples) throw std::invalid_argument("CrossingDetector: chunk longer than max_samples");
+    n_events = 0;
+    const int first_active = static_cast<int>(std::clamp<long>(quiet_until - first_sample_idx + 1, 0, n_samples));
+
+    // nothing to do without crossings and with every channel out of its refractory period
+    uint32_t pending = 0;
+    const size_t first_word = static_cast<size_t>(first_active) * n_blocks, end_word = static_cast<size_t>(n_samples) * n_blocks;
+    for (size_t i = first_word; i < end_word; i++) pending |= crossings[i];
+    for (uint32_t planes : countdown) pending |= planes;
+    if (not pending) return;
+
+    // fired masks block by block, the counters of a block stay in registers
+    uint32_t any_fired = 0;
+    for (int block = 0; block < n_blocks; block++) {
+        uint32_t *planes = &countdown[static_cast<size_t>(block) * countdown_bits];
+        uint32_t c0 = planes[0], c1 = planes[1], c2 = planes[2], c3 = planes[3];
+        for (int s = 0; s < n_samples; s++) {
+            const uint32_t blocked = c0 | c1 | c2 | c3;
+            const uint32_t crossing = s < first_active ? 0 : crossings[static_cast<size_t>(s) * n_blocks + block];
+            const uint32_t mask = crossing & ~blocked;
+            // counters of the blocked lanes minus one, bit plane by bit plane
+            const uint32_t borrow1 = blocked & ~c0, borrow2 = borrow1 & ~c1, borrow3 = borrow2 & ~c2;
+            c0 ^= blocked;
+            c1 ^= borrow1;
+            c2 ^= borrow2;
+            c3 ^= borrow3;
+            // lanes that fire start at refractory_samples, their counters were zero
+            if constexpr ((refractory_samples & 1) != 0) c0 |= mask;
+            if constexpr ((refractory_samples & 2) != 0) c1 |= mask;
+            if constexpr ((refractory_samples & 4) != 0) c2 |= mask;
+            if constexpr ((refractory_samples & 8) != 0) c3 |= mask;
+            fired[static_cast<size_t>(s) * n_blocks + block] = mask;
+            any_fired |= mask;
+        }
+        planes[0] = c0;
+        planes[1] = c1;
+        planes[2] = c2;
+        planes[3] = c3;
+    }
+    if (not any_fired) return;
+
+    // one event per set bit, in sample order and lowest channel first
+    for (int s = first_active; s < n_samples; s++) {
+        const uint32_t *fired_row = &fired[static_cast<size_t>(s) * n_blocks];
+        for (int block = 0; block < n_blocks; block++) {
+            for (uint32_t mask = fired_row[block]; mask; mask &= mask - 1) {
+                events[n_events++] = {first_channel + block * lanes + std::countr_zero(mask), first_sample_idx + s};
+            }
+        }
+    }
+}
@@ -0,0 +1,52 @@
+#ifndef CROSSING_DETECTOR_H
+#define CROSSING_DETECTOR_H
+
+#include <cstdint>
+#include <span>
+#include <vector>
+#include "spike_event.h"
+
+// Turns the threshold crossing bitmasks of the detecting filter kernels
+// (one word per time step and block of `lanes` channels, see
+// filter_kernels.h) into spike events. A crossing is a spike unless its
+// channel fired in the previous refractory_samples samples. Each channel
+// has a countdown of the remaining refractory samples, stored bit-sliced:
+// bit plane k of a block holds bit k of the counters of its channels. A
+// time step tests and updates all of a block's channels at once,
+//   blocked = c0 | c1 | c2 | c3        fired = crossings & ~blocked
+//   counters of the blocked channels minus one (borrow through the planes)
+//   counters of the fired channels = refractory_samples
+// so it costs the same with no spikes and with a burst on every channel, only
+// writing the events depends on the spike rate. The counters carry over to
+// the next chunk. Events go into an array sized for the most spikes a chunk
+// can hold.
+class CrossingDetector {
+public:
+    static constexpr int refractory_samples = 10;   // at most 15 with four counter bits
+
+    // max_samples: longest chunk, the events of the channels are numbered from first_channel
+    CrossingDetector(int n_channel, int lanes, int max_samples, int first_channel = 0);
+
+    // crossings [sample][block] of n_samples time steps from first_sample_idx,
+    // crossings up to sample index `quiet_until` are ignored (warm-up)
+    void process(const uint32_t *crossings, int n_samples, long first_sample_idx, long quiet_until = -1);
+
+    // events of the last chunk, in (sample, channel) order
+    [[nodiscard]] std::span<const SpikeEvent> getEvents() const { return {events.data(), n_events}; }
+    [[nodiscard]] int getBlockCount() const { return n_blocks; }
+
+private:
+    static constexpr int countdown_bits = 4;
+    static_assert(refractory_samples < (1 << countdown_bits));
+
+    int lanes;
+    int n_blocks;
+    int max_samples;
+    int first_channel;
+    std::vector<uint32_t> countdown;    // [block][bit plane]
+    std::vector<uint32_t> fired;        // [sample][block] spikes of the current chunk
+    std::vector<SpikeEvent> events;     // preallocated
+    size_t n_events;
+};
+
+#endif //CROSSING_DETECTOR_H
@@ -0,0 +1,93 @@
+#include "noise_estimator.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "../../lib/config.h"
+#include "../../lib/simd.h"
+
+template <typename T>
+RobustNoiseEstimator<T>::RobustNoiseEstimator(int n_channel, double sampling_rate, double time_constant,
+                                              int update_interval, double threshold_factor)
+    : n_channel(n_channel), update_interval(std::max(1, update_interval)),
+      settle_samples(std::lround(NoiseConfig::settling * std::max(1.0, time_constant * sampling_rate))),
+      alpha(static_cast<T>(1.0 / std::max(1.0, time_constant * sampling_rate))),
+      threshold_scale(static_cast<T>(-threshold_factor / 0.6745)) {
+    const int n = simd::padded<T>(n_channel);
+    mean_abs.assign(n, 0);
+    median_abs.assign(n, 0);
+    threshold.assign(n, -std::numeric_limits<T>::infinity());
+}
+
+template <typename T>
+void RobustNoiseEstimator<T>::update(const T *in, int n_samples, int stride, long first_sample_idx) {
+    using V = simd::Vec<T>;
+    const V valpha = V::broadcast(alpha);
+    const V one = V::broadcast(1), minus_one = V::broadcast(-1);
+
+    // split the chunk at multiples of update_interval, the thresholds are refreshed in between
+    int s = 0;
+    while (s < n_samples) {
+        const int segment_end = s + segmentLength(first_sample_idx + s, n_samples - s);
+
+        int c = 0;
+        for (; c + V::width <= n_channel; c += V::width) {
+            V ma = V::load(&mean_abs[c]), med = V::load(&median_abs[c]);
+            for (int i = s; i < segment_end; i++) {
+                const V ax = abs(V::loadu(in + i * stride + c));
+                ma = fmadd(valpha, ax - ma, ma);
+                med = fmadd(valpha * ma, select_gt(ax, med, one, minus_one), med);
+            }
+            ma.store(&mean_abs[c]);
+            med.store(&median_abs[c]);
+        }
+        for (; c < n_channel; c++) {
+            T ma = mean_abs[c], med = median_abs[c];
+            for (int i = s; i < segment_end; i++) {
+                const T ax = in[i * stride + c] < 0 ? -in[i * stride + c] : in[i * stride + c];
+                ma += alpha * (ax - ma);
+                med += alpha * ma * (ax > med ? T(1) : T(-1));
+            }
+            mean_abs[c] = ma;
+            median_abs[c] = med;
+        }
+
+        endSegment(first_sample_idx + segment_end);
+        s = segment_end;
+    }
+}
+
+template <typename T>
+int RobustNoiseEstimator<T>::segmentLength(long sample_idx, int n_samples) const {
+    return static_cast<int>(std::min<long>(n_samples, update_interval - sample_idx % update_interval));
+}
+
+template <typename T>
+void RobustNoiseEstimator<T>::endSegment(long end_sample_idx) {
+    if (end_sample_idx % update_interval != 0) return;
+    if (end_sample_idx < settle_samples) seedMedian(end_sample_idx);
+    else updateThresholds();
+}
+
+template <typename T>
+void RobustNoiseEstimator<T>::seedMedian(long n_samples) {
+    using V = simd::Vec<T>;
+    // mean_abs started at zero and weighs the n samples seen with 1 - (1 - alpha)^n in total
+    const double weight = 1.0 - std::pow(1.0 - static_cast<double>(alpha), static_cast<double>(n_samples));
+    // median(|x|) / mean(|x|) = 0.6745 / sqrt(2 / pi) for Gaussian noise
+    const V scale = V::broadcast(static_cast<T>(0.6745 / std::sqrt(2.0 / M_PI) / weight));
+    for (int c = 0; c < static_cast<int>(median_abs.size()); c += V::width) {
+        (V::load(&mean_abs[c]) * scale).store(&median_abs[c]);
+    }
+}
+
+template <typename T>
+void RobustNoiseEstimator<T>::updateThresholds() {
+    using V = simd::Vec<T>;
+    const V scale = V::broadcast(threshold_scale);
+    for (int c = 0; c < static_cast<int>(threshold.size()); c += V::width) {
+        (V::load(&median_abs[c]) * scale).store(&threshold[c]);
+    }
+}
+
+template class RobustNoiseEstimator<float>;
+template class RobustNoiseEstimator<double>;
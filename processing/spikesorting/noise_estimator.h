@@ -0,0 +1,54 @@
+#ifndef NOISE_ESTIMATOR_H
+#define NOISE_ESTIMATOR_H
+
+#include "../../lib/aligned_allocator.h"
+#include "../filter/filter_kernels.h"
+
+// Exponentially forgetting robust noise estimate for a block of channels.
+// Follows Quiroga et al. (2004): sigma = median(|x|) / 0.6745. The median of
+// |x| is tracked with a sign-step (stochastic approximation) update whose
+// step size scales with a running mean of |x|, so it adapts to drift with
+// the given time constant and needs no sample history. The detection
+// threshold -factor * sigma is only recomputed every update_interval
+// samples and cached per channel. Both estimates start at zero. Until
+// NoiseConfig::settling time constants have passed, every refresh seeds the
+// median from the bias-corrected mean of |x| (median/mean of a Gaussian |x|,
+// the sign steps alone would need several time constants to climb there)
+// and the thresholds stay at -inf, so nothing crosses.
+template <typename T>
+class RobustNoiseEstimator {
+public:
+    RobustNoiseEstimator(int n_channel, double sampling_rate, double time_constant,
+                         int update_interval, double threshold_factor);
+
+    // updates the estimates with n_samples time steps (consecutive samples `stride` apart)
+    void update(const T *in, int n_samples, int stride, long first_sample_idx);
+
+    // Updating through a fused filter kernel instead: the kernel updates the
+    // view's estimates over segments of at most segmentLength samples, after
+    // each one endSegment refreshes the thresholds when they are due.
+    [[nodiscard]] NoiseView<T> getView() { return {mean_abs.data(), median_abs.data(), threshold.data(), alpha}; }
+    [[nodiscard]] int segmentLength(long sample_idx, int n_samples) const;
+    void endSegment(long end_sample_idx);
+
+    // cached thresholds, one per channel (negative)
+    [[nodiscard]] const T *getThresholds() const { return threshold.data(); }
+    // current noise standard deviation estimate of a channel
+    [[nodiscard]] T getNoiseLevel(int channel) const { return median_abs[channel] * T(1 / 0.6745); }
+    [[nodiscard]] int getChannelCount() const { return n_channel; }
+
+private:
+    int n_channel;
+    int update_interval;
+    long settle_samples;        // first sample index with a converged estimate
+    T alpha;                    // forgetting factor per sample
+    T threshold_scale;          // -threshold_factor / 0.6745
+    aligned_vector<T> mean_abs;
+    aligned_vector<T> median_abs;
+    aligned_vector<T> threshold;
+
+    void updateThresholds();
+    void seedMedian(long n_samples);
+};
+
+#endif //NOISE_ESTIMATOR_H
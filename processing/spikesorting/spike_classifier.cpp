@@ -0,0 +1,101 @@
+#include "spike_classifier.h"
+#include <iostream>
+
+SpikeClassifier::SpikeClassifier(const std::string &model_path, int input_size, PipelineMetrics *metrics)
+    : input_size(input_size), metrics(metrics) {
+    model = torch::jit::load(model_path);
+    model.eval();
+    worker = std::thread(&SpikeClassifier::inferenceLoop, this);
+}
+
+SpikeClassifier::~SpikeClassifier() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+    }
+    request_cv.notify_one();
+    worker.join();
+}
+
+SpikeBatch SpikeClassifier::acquire() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (free_batches.empty()) return {};
+    SpikeBatch batch = std::move(free_batches.back());
+    free_batches.pop_back();
+    batch.clear();
+    return batch;
+}
+
+void SpikeClassifier::submit(SpikeBatch batch) {
+    if (batch.size() == 0) {
+        release(std::move(batch));
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        n_pending += batch.size();
+        requests.push_back(std::move(batch));
+    }
+    request_cv.notify_one();
+}
+
+size_t SpikeClassifier::poll(std::vector<SpikeBatch> &done) {
+    std::lock_guard<std::mutex> lock(mutex);
+    const size_t n_batches = completed.size();
+    while (!completed.empty()) {
+        n_pending -= completed.front().size();
+        done.push_back(std::move(completed.front()));
+        completed.pop_front();
+    }
+    return n_batches;
+}
+
+void SpikeClassifier::release(SpikeBatch batch) {
+    std::lock_guard<std::mutex> lock(mutex);
+    free_batches.push_back(std::move(batch));
+}
+
+size_t SpikeClassifier::pending() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return n_pending;
+}
+
+void SpikeClassifier::inferenceLoop() {
+    while (true) {
+        SpikeBatch batch;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            request_cv.wait(lock, [this] { return stop or !requests.empty(); });
+            if (stop) return;
+            batch = std::move(requests.front());
+            requests.pop_front();
+        }
+
+        const uint64_t start = PipelineMetrics::now();
+        try {
+            classify(batch);
+        } catch (const std::exception &e) {
+            std::cerr << "Spike classification failed: " << e.what() << std::endl;
+            batch.labels.assign(batch.size(), -1);
+        }
+        metrics->record(Stage::infer, start);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        completed.push_back(std::move(batch));
+    }
+}
+
+void SpikeClassifier::classify(SpikeBatch &batch) {
+    c10::InferenceMode guard;
+    const auto n = static_cast<int64_t>(batch.size());
+    torch::Tensor input = torch::from_blob(batch.waveforms.data(), {n, input_size}, torch::kFloat32);
+
+    // the model returns (logits, argmax(logits)), plain logits are accepted as well
+    auto output = model.forward({input});
+    torch::Tensor labels = output.isTuple() ? output.toTuple()->elements()[1].toTensor()
+                                            : output.toTensor().argmax(1);
+    labels = labels.to(torch::kInt64).contiguous();
+
+    const int64_t *label_data = labels.data_ptr<int64_t>();
+    batch.labels.assign(label_data, label_data + n);
+}
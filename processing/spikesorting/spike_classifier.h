@@ -0,0 +1,72 @@
+#ifndef SPIKE_CLASSIFIER_H
+#define SPIKE_CLASSIFIER_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <torch/script.h>
+#include "spike_event.h"
+#include "../pipeline/metrics.h"
+
+// A batch of extracted spikes, row-major [n, input_size] float32 waveforms.
+// labels is filled in by the classifier.
+struct SpikeBatch {
+    std::vector<SpikeEvent> events;
+    std::vector<float> waveforms;
+    std::vector<int64_t> labels;
+
+    [[nodiscard]] size_t size() const { return events.size(); }
+    void clear() {
+        events.clear();
+        waveforms.clear();
+        labels.clear();
+    }
+};
+
+// Runs the TorchScript spike classifier on its own thread. Batches are
+// submitted to a request queue, classified with one forward pass each under
+// c10::InferenceMode and handed back through a completion queue. Batch
+// buffers are recycled, so steady state runs without allocations.
+class SpikeClassifier {
+public:
+    SpikeClassifier(const std::string &model_path, int input_size, PipelineMetrics *metrics);
+    ~SpikeClassifier();
+
+    SpikeClassifier(const SpikeClassifier &) = delete;
+    SpikeClassifier &operator=(const SpikeClassifier &) = delete;
+
+    // empty batch with recycled buffers
+    SpikeBatch acquire();
+    void submit(SpikeBatch batch);
+    // moves all classified batches into done (non-blocking), returns the number of batches
+    size_t poll(std::vector<SpikeBatch> &done);
+    // hands a processed batch back for reuse
+    void release(SpikeBatch batch);
+
+    // spikes submitted but not yet polled
+    [[nodiscard]] size_t pending() const;
+    [[nodiscard]] int getInputSize() const { return input_size; }
+
+private:
+    torch::jit::script::Module model;
+    int input_size;
+    PipelineMetrics *metrics;
+
+    mutable std::mutex mutex;
+    std::condition_variable request_cv;
+    std::deque<SpikeBatch> requests;
+    std::deque<SpikeBatch> completed;
+    std::vector<SpikeBatch> free_batches;
+    size_t n_pending = 0;
+    bool stop = false;
+    std::thread worker;
+
+    void inferenceLoop();
+    void classify(SpikeBatch &batch);
+};
+
+#endif //SPIKE_CLASSIFIER_H
@@ -0,0 +1,233 @@
+#include "spike_detector.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include "../../lib/simd.h"
+
+DetectorType parseDetectorType(const std::string &name) {
+    if (name == "amplitude") return DetectorType::amplitude;
+    if (name == "neo") return DetectorType::neo;
+    if (name == "matched") return DetectorType::matched;
+    throw std::invalid_argument("Unsupported detector type: " + name);
+}
+
+std::vector<std::vector<double>> readTemplates(const std::string &path) {
+    std::ifstream file(path);
+    if (!file) throw std::runtime_error("Cannot open template file: " + path);
+    std::vector<std::vector<double>> templates;
+    std::string line;
+    while (std::getline(file, line)) {
+        std::replace(line.begin(), line.end(), ';', ',');
+        if (line.empty() or line == "\r") continue;
+        std::vector<double> row;
+        std::stringstream ss(line);
+        std::string value;
+        while (std::getline(ss, value, ',')) {
+            if (value.find_first_not_of(" \t\r") != std::string::npos) row.push_back(std::stod(value));
+        }
+        templates.push_back(std::move(row));
+    }
+    return templates;
+}
+
+// negative Ricker wavelet of 1 ms, sigma = 0.15 ms
+static std::vector<double> genericTemplate(int sampling_rate) {
+    const int length = static_cast<int>(std::lround(0.001 * sampling_rate)) | 1;
+    const double sigma = 0.00015 * sampling_rate;
+    std::vector<double> spike(length);
+    for (int k = 0; k < length; k++) {
+        const double u = (k - (length - 1) / 2) / sigma;
+        spike[k] = -(1.0 - u * u) * std::exp(-u * u / 2.0);
+    }
+    return spike;
+}
+
+template <typename T>
+AmplitudeDetector<T>::AmplitudeDetector(int n_channel, const Config &cfg)
+    : n_channel(n_channel),
+      noise(n_channel, cfg.sampling_rate, cfg.noise.time_constant, cfg.noise.update_interval, cfg.detector.threshold),
+      view(noise.getView()) {}
+
+template <typename T>
+void AmplitudeDetector<T>::detect(const T *filtered, int n_samples, int stride, uint32_t *crossings) {
+    updateNoiseAndDetect(view, filtered, n_samples, stride, n_channel, crossings);
+}
+
+template <typename T>
+NeoDetector<T>::NeoDetector(int n_channel, const Config &cfg)
+    : n_channel(n_channel), n_padded(simd::padded<T>(n_channel)), window(cfg.detector.neo_window),
+      alpha(static_cast<T>(1.0 / std::max(1.0, cfg.noise.time_constant * cfg.sampling_rate))),
+      threshold_factor(static_cast<T>(cfg.detector.threshold)) {
+    if (window < 1 or window % 2 == 0) {
+        throw std::invalid_argument("detector.neo_window must be odd and positive: " + std::to_string(window));
+    }
+    // triangle of height (window + 1) / 2, normalised to unit sum
+    weights.resize(window);
+    double sum = 0.0;
+    for (int k = 0; k < window; k++) sum += (window + 1) / 2 - std::abs(k - window / 2);
+    for (int k = 0; k < window; k++) weights[k] = static_cast<T>(((window + 1) / 2 - std::abs(k - window / 2)) / sum);
+    x1.assign(n_padded, 0);
+    x2.assign(n_padded, 0);
+    mean.assign(n_padded, 0);
+    energy.assign(static_cast<size_t>(window - 1 + cfg.buffer.chunk_size) * n_padded, 0);
+}
+
+template <typename T>
+void NeoDetector<T>::detect(const T *filtered, int n_samples, int stride, uint32_t *crossings) {
+    using V = simd::Vec<T>;
+    T *psi = &energy[static_cast<size_t>(window - 1) * n_padded];
+
+    // energy of the previous sample, x[n-1]^2 - x[n-2] x[n]
+    int c = 0;
+    for (; c + V::width <= n_channel; c += V::width) {
+        V p1 = V::load(&x1[c]), p2 = V::load(&x2[c]);
+        for (int s = 0; s < n_samples; s++) {
+            const V x = V::loadu(filtered + s * stride + c);
+            fnmadd(p2, x, p1 * p1).store(&psi[s * n_padded + c]);
+            p2 = p1;
+            p1 = x;
+        }
+        p1.store(&x1[c]);
+        p2.store(&x2[c]);
+    }
+    for (; c < n_channel; c++) {
+        T p1 = x1[c], p2 = x2[c];
+        for (int s = 0; s < n_samples; s++) {
+            const T x = filtered[s * stride + c];
+            psi[s * n_padded + c] = p1 * p1 - p2 * x;
+            p2 = p1;
+            p1 = x;
+        }
+        x1[c] = p1;
+        x2[c] = p2;
+    }
+
+    // smoothed energy against a multiple of its mean, the padding lanes stay zero and never cross
+    const V valpha = V::broadcast(alpha), factor = V::broadcast(threshold_factor);
+    const int n_blocks = n_padded / V::width;
+    for (int block = 0; block < n_blocks; block++) {
+        const int offset = block * V::width;
+        V m = V::load(&mean[offset]);
+        for (int s = 0; s < n_samples; s++) {
+            const T *frames = &energy[static_cast<size_t>(s) * n_padded + offset];
+            V smoothed = V::zero();
+            for (int k = 0; k < window; k++) smoothed = fmadd(V::broadcast(weights[k]), V::load(frames + k * n_padded), smoothed);
+            m = fmadd(valpha, smoothed - m, m);
+            crossings[s * n_blocks + block] = mask_gt(smoothed, factor * m);
+        }
+        m.store(&mean[offset]);
+    }
+
+    // the last window - 1 values start the next segment
+    std::memmove(energy.data(), &energy[static_cast<size_t>(n_samples) * n_padded], (window - 1) * n_padded * sizeof(T));
+}
+
+template <typename T>
+MatchedFilterDetector<T>::MatchedFilterDetector(int n_channel, const Config &cfg, const std::vector<std::vector<double>> &templates)
+    : n_channel(n_channel), n_padded(simd::padded<T>(n_channel)),
+      noise(n_channel, cfg.sampling_rate, cfg.noise.time_constant, cfg.noise.update_interval, cfg.detector.threshold),
+      view(noise.getView()) {
+    if (templates.size() != 1 and templates.size() != static_cast<size_t>(n_channel)) {
+        throw std::invalid_argument("MatchedFilterDetector needs one template or one per channel, got " +
+                                    std::to_string(templates.size()) + " for " + std::to_string(n_channel) + " channels");
+    }
+    // common length with all troughs at tap `trough`
+    int trough = 0, after = 0;
+    for (const auto &spike : templates) {
+        if (spike.empty()) throw std::invalid_argument("Empty matched filter template");
+        const int p = static_cast<int>(std::min_element(spike.begin(), spike.end()) - spike.begin());
+        trough = std::max(trough, p);
+        after = std::max(after, static_cast<int>(spike.size()) - p);
+    }
+    length = trough + after;
+    delay = after - 1;
+
+    // unit energy, negated: a matching spike correlates to a negative output
+    taps.assign(static_cast<size_t>(length) * n_padded, 0);
+    for (int c = 0; c < n_channel; c++) {
+        const auto &spike = templates[templates.size() == 1 ? 0 : c];
+        const int p = static_cast<int>(std::min_element(spike.begin(), spike.end()) - spike.begin());
+        double energy = 0.0;
+        for (double v : spike) energy += v * v;
+        if (energy <= 0.0) throw std::invalid_argument("Matched filter template without energy");
+        const double scale = -1.0 / std::sqrt(energy);
+        for (size_t k = 0; k < spike.size(); k++) {
+            taps[(trough - p + k) * n_padded + c] = static_cast<T>(spike[k] * scale);
+        }
+    }
+    history.assign(static_cast<size_t>(length - 1 + cfg.buffer.chunk_size) * n_padded, 0);
+    output.assign(static_cast<size_t>(cfg.buffer.chunk_size) * n_padded, 0);
+}
+
+template <typename T>
+void MatchedFilterDetector<T>::detect(const T *filtered, int n_samples, int stride, uint32_t *crossings) {
+    using V = simd::Vec<T>;
+    T *frames = &history[static_cast<size_t>(length - 1) * n_padded];
+    for (int s = 0; s < n_samples; s++) std::copy_n(filtered + s * stride, n_channel, &frames[s * n_padded]);
+
+    // output n correlates the template with the inputs n - length + 1 .. n,
+    // four outputs share each load of a tap
+    for (int c = 0; c < n_padded; c += V::width) {
+        int s = 0;
+        for (; s + 4 <= n_samples; s += 4) {
+            const T *in = &history[static_cast<size_t>(s) * n_padded + c];
+            V acc0 = V::zero(), acc1 = V::zero(), acc2 = V::zero(), acc3 = V::zero();
+            for (int k = 0; k < length; k++) {
+                const V tap = V::load(&taps[k * n_padded + c]);
+                const T *frame = in + k * n_padded;
+                acc0 = fmadd(tap, V::load(frame), acc0);
+                acc1 = fmadd(tap, V::load(frame + n_padded), acc1);
+                acc2 = fmadd(tap, V::load(frame + 2 * n_padded), acc2);
+                acc3 = fmadd(tap, V::load(frame + 3 * n_padded), acc3);
+            }
+            acc0.store(&output[s * n_padded + c]);
+            acc1.store(&output[(s + 1) * n_padded + c]);
+            acc2.store(&output[(s + 2) * n_padded + c]);
+            acc3.store(&output[(s + 3) * n_padded + c]);
+        }
+        for (; s < n_samples; s++) {
+            const T *in = &history[static_cast<size_t>(s) * n_padded + c];
+            V acc = V::zero();
+            for (int k = 0; k < length; k++) acc = fmadd(V::load(&taps[k * n_padded + c]), V::load(in + k * n_padded), acc);
+            acc.store(&output[s * n_padded + c]);
+        }
+    }
+    updateNoiseAndDetect(view, output.data(), n_samples, n_padded, n_channel, crossings);
+
+    // the last length - 1 inputs start the next segment
+    std::memmove(history.data(), &history[static_cast<size_t>(n_samples) * n_padded], (length - 1) * n_padded * sizeof(T));
+}
+
+template <typename T>
+std::unique_ptr<SpikeDetector<T>> makeSpikeDetector(const Config &cfg, int first_channel, int n_channel) {
+    const DetectorType type = parseDetectorType(cfg.detector.type);
+    if (type == DetectorType::neo) return std::make_unique<NeoDetector<T>>(n_channel, cfg);
+    if (type == DetectorType::matched) {
+        if (cfg.detector.templates.empty()) {
+            const std::vector<std::vector<double>> generic{genericTemplate(cfg.sampling_rate)};
+            return std::make_unique<MatchedFilterDetector<T>>(n_channel, cfg, generic);
+        }
+        const auto templates = readTemplates(cfg.detector.templates);
+        if (templates.size() == 1) return std::make_unique<MatchedFilterDetector<T>>(n_channel, cfg, templates);
+        if (templates.size() != static_cast<size_t>(cfg.n_channel)) {
+            throw std::runtime_error(cfg.detector.templates + " has " + std::to_string(templates.size()) +
+                                     " templates, need one or one per channel (" + std::to_string(cfg.n_channel) + ")");
+        }
+        const std::vector<std::vector<double>> shard_templates(templates.begin() + first_channel,
+                                                               templates.begin() + first_channel + n_channel);
+        return std::make_unique<MatchedFilterDetector<T>>(n_channel, cfg, shard_templates);
+    }
+    return std::make_unique<AmplitudeDetector<T>>(n_channel, cfg);
+}
+
+template class AmplitudeDetector<float>;
+template class AmplitudeDetector<double>;
+template class NeoDetector<float>;
+template class NeoDetector<double>;
+template class MatchedFilterDetector<float>;
+template class MatchedFilterDetector<double>;
+template std::unique_ptr<SpikeDetector<float>> makeSpikeDetector<float>(const Config &, int, int);
+template std::unique_ptr<SpikeDetector<double>> makeSpikeDetector<double>(const Config &, int, int);
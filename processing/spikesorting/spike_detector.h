@@ -0,0 +1,122 @@
+#ifndef SPIKE_DETECTOR_H
+#define SPIKE_DETECTOR_H
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "../../lib/aligned_allocator.h"
+#include "../../lib/config.h"
+#include "../filter/filter_kernels.h"
+#include "noise_estimator.h"
+
+enum class DetectorType { amplitude, neo, matched };
+DetectorType parseDetectorType(const std::string &name);
+
+// matched filter templates, one row of comma or semicolon separated values per line
+std::vector<std::vector<double>> readTemplates(const std::string &path);
+
+// Turns the filtered samples of a block of channels into threshold crossing
+// masks in the layout of the detecting filter kernels (filter_kernels.h),
+// which the CrossingDetector turns into spike events. The pipeline hands
+// each chunk over in segments of at most segmentLength samples and calls
+// endSegment after each one. A detector that compares a smoothed or
+// filtered version of the signal reports a crossing `getDelay()` samples
+// after the spike sample it belongs to.
+template <typename T>
+class SpikeDetector {
+public:
+    virtual ~SpikeDetector() = default;
+
+    // writes the crossing masks of n_samples time steps, consecutive samples `stride` apart
+    virtual void detect(const T *filtered, int n_samples, int stride, uint32_t *crossings) = 0;
+
+    [[nodiscard]] virtual int segmentLength(long /*sample_idx*/, int n_samples) const { return n_samples; }
+    virtual void endSegment(long) {}
+    [[nodiscard]] virtual int getDelay() const { return 0; }
+    // noise state for IIR kernels that detect while filtering, nullptr if detect needs its own pass
+    [[nodiscard]] virtual const NoiseView<T> *getFusedNoise() { return nullptr; }
+};
+
+// x < -threshold * sigma with the robust noise estimate of each channel,
+// fused into the IIR kernels where the filter bank has them
+template <typename T>
+class AmplitudeDetector final : public SpikeDetector<T> {
+public:
+    AmplitudeDetector(int n_channel, const Config &cfg);
+
+    void detect(const T *filtered, int n_samples, int stride, uint32_t *crossings) override;
+    [[nodiscard]] int segmentLength(long sample_idx, int n_samples) const override { return noise.segmentLength(sample_idx, n_samples); }
+    void endSegment(long end_sample_idx) override { noise.endSegment(end_sample_idx); }
+    [[nodiscard]] const NoiseView<T> *getFusedNoise() override { return &view; }
+
+private:
+    int n_channel;
+    RobustNoiseEstimator<T> noise;
+    NoiseView<T> view;
+};
+
+// Smoothed nonlinear energy operator (Mukhopadhyay & Ray 1998):
+//   psi[n] = x[n]^2 - x[n-1] x[n+1]
+// convolved with a Bartlett window of `window` samples, compared against
+// threshold times its exponentially forgetting mean (noise.time_constant).
+// A time step computes psi of the previous sample for a channel block in
+// registers (x[n-1] and x[n-2] carry over between chunks) and stores it
+// time-major behind the last window - 1 values, then the smoothing runs
+// over that buffer, window FMAs per block and sample. The smoothed energy is
+// centred window / 2 + 1 samples back.
+template <typename T>
+class NeoDetector final : public SpikeDetector<T> {
+public:
+    NeoDetector(int n_channel, const Config &cfg);
+
+    void detect(const T *filtered, int n_samples, int stride, uint32_t *crossings) override;
+    [[nodiscard]] int getDelay() const override { return window / 2 + 1; }
+
+private:
+    int n_channel;
+    int n_padded;
+    int window;
+    T alpha;                    // forgetting factor of the mean energy per sample
+    T threshold_factor;
+    std::vector<T> weights;     // [window] Bartlett window, unit sum
+    aligned_vector<T> x1, x2;   // [channel] x[n-1], x[n-2]
+    aligned_vector<T> mean;     // [channel] mean smoothed energy
+    aligned_vector<T> energy;   // [window - 1 + max_samples][n_padded] psi, time-major
+};
+
+// Correlates each channel with its own template (unit energy, sign flipped
+// so that a matching spike gives a negative output) and detects on the
+// output like the amplitude detector, with a robust noise estimate of the
+// filter output. The segment is copied time-major behind the last L - 1
+// samples (L = template length), an output costs L FMAs per channel block.
+// The templates are aligned on their troughs, a trough at tap p reports
+// spikes L - 1 - p samples late. Without a template file all channels use a
+// generic 1 ms spike, a negative Ricker wavelet with sigma = 0.15 ms.
+template <typename T>
+class MatchedFilterDetector final : public SpikeDetector<T> {
+public:
+    // templates: one per channel of the shard, or a single one for all
+    MatchedFilterDetector(int n_channel, const Config &cfg, const std::vector<std::vector<double>> &templates);
+
+    void detect(const T *filtered, int n_samples, int stride, uint32_t *crossings) override;
+    [[nodiscard]] int segmentLength(long sample_idx, int n_samples) const override { return noise.segmentLength(sample_idx, n_samples); }
+    void endSegment(long end_sample_idx) override { noise.endSegment(end_sample_idx); }
+    [[nodiscard]] int getDelay() const override { return delay; }
+
+private:
+    int n_channel;
+    int n_padded;
+    int length;                 // templates are aligned on their troughs and zero padded to a common length
+    int delay;
+    aligned_vector<T> taps;     // [tap][n_padded]
+    aligned_vector<T> history;  // [length - 1 + max_samples][n_padded] input, time-major
+    aligned_vector<T> output;   // [max_samples][n_padded]
+    RobustNoiseEstimator<T> noise;
+    NoiseView<T> view;
+};
+
+// the detector of cfg.detector.type for channels first_channel .. first_channel + n_channel - 1
+template <typename T>
+std::unique_ptr<SpikeDetector<T>> makeSpikeDetector(const Config &cfg, int first_channel, int n_channel);
+
+#endif //SPIKE_DETECTOR_H
@@ -0,0 +1,9 @@
+#ifndef SPIKE_EVENT_H
+#define SPIKE_EVENT_H
+
+struct SpikeEvent {
+    int channel;
+    long timestamp;
+};
+
+#endif //SPIKE_EVENT_H
@@ -0,0 +1,133 @@
+#include "waveform_aligner.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include "../../lib/simd.h"
+
+Interpolation parseInterpolation(const std::string &name) {
+    if (name == "none") return Interpolation::none;
+    if (name == "cubic") return Interpolation::cubic;
+    if (name == "sinc") return Interpolation::sinc;
+    throw std::invalid_argument("Unsupported interpolation: " + name);
+}
+
+// Keys' cubic convolution kernel, a = -0.5
+static double cubicKernel(double x) {
+    constexpr double a = -0.5;
+    x = std::abs(x);
+    if (x <= 1.0) return ((a + 2.0) * x - (a + 3.0)) * x * x + 1.0;
+    if (x < 2.0) return ((a * x - 5.0 * a) * x + 8.0 * a) * x - 4.0 * a;
+    return 0.0;
+}
+
+// Lanczos kernel, sinc(x) sinc(x / a) for |x| < a
+static double lanczosKernel(double x, int a) {
+    if (x == 0.0) return 1.0;
+    if (std::abs(x) >= a) return 0.0;
+    const double px = M_PI * x;
+    return a * std::sin(px) * std::sin(px / a) / (px * px);
+}
+
+template <typename T>
+WaveformAligner<T>::WaveformAligner(int length, int window, Interpolation interpolation)
+    : length(length), window(std::max(window, 1)),
+      taps(interpolation == Interpolation::cubic ? 4 : interpolation == Interpolation::sinc ? 8 : 0), half_taps(taps / 2) {
+    if (length < 1) throw std::invalid_argument("WaveformAligner: waveform length must be positive");
+    // the last peak candidate is window - 1 samples after the crossing
+    lookahead = this->window - 1 + length - length / 2 + half_taps;
+    search.assign(simd::padded<T>(this->window), std::numeric_limits<T>::infinity());
+    scratch.assign(static_cast<size_t>(length) + this->window - 1 + 2 * half_taps, T(0));
+
+    // kernels[phase][k] weighs the sample k - half_taps + 1 positions from the base for the
+    // value phase / upsampling after it
+    kernels.assign(static_cast<size_t>(upsampling) * taps, T(0));
+    for (int phase = 0; phase < upsampling and taps > 0; phase++) {
+        const double offset = static_cast<double>(phase) / upsampling;
+        double weights[8];
+        double sum = 0.0;
+        for (int k = 0; k < taps; k++) {
+            const double x = offset - (k - half_taps + 1);
+            weights[k] = interpolation == Interpolation::cubic ? cubicKernel(x) : lanczosKernel(x, half_taps);
+            sum += weights[k];
+        }
+        for (int k = 0; k < taps; k++) kernels[phase * taps + k] = static_cast<T>(weights[k] / sum);
+    }
+}
+
+template <typename T>
+int WaveformAligner<T>::argmin(const T *samples) {
+    using V = simd::Vec<T>;
+    std::memcpy(search.data(), samples, window * sizeof(T));
+    const int n = static_cast<int>(search.size());
+    V lowest = V::load(&search[0]);
+    for (int i = V::width; i < n; i += V::width) lowest = min(lowest, V::load(&search[i]));
+    alignas(64) T lanes[V::width];
+    lowest.store(lanes);
+    const V peak = V::broadcast(*std::min_element(lanes, lanes + V::width));
+    constexpr uint32_t all_lanes = (1u << V::width) - 1;
+    for (int i = 0;; i += V::width) {
+        // lanes not above the minimum are equal to it
+        const uint32_t hits = ~mask_gt(V::load(&search[i]), peak) & all_lanes;
+        if (hits) return i + std::countr_zero(hits);
+    }
+}
+
+template <typename T>
+T WaveformAligner<T>::interpolate(const T *samples, int phase) const {
+    const T *kernel = &kernels[phase * taps];
+    T value = 0;
+    for (int k = 0; k < taps; k++) value += kernel[k] * samples[k];
+    return value;
+}
+
+template <typename T>
+bool WaveformAligner<T>::extract(const HistoryBuffer<T> &history, const SpikeEvent &event, long n_written, T *waveform) {
+    using V = simd::Vec<T>;
+    // scratch starts half a waveform and the kernel margin before the crossing
+    const int origin = length / 2 + half_taps;
+    const long first = event.timestamp - origin;
+    const int n = static_cast<int>(scratch.size());
+    if (!history.contains(first, n, n_written)) return false;
+    history.copy(event.channel, first, n, scratch.data());
+
+    const int peak = window > 1 ? origin + argmin(&scratch[origin]) : origin;
+
+    // the interpolated minimum lies between the peak and its lower neighbour,
+    // as base sample + phase
+    int base = peak, phase = 0;
+    if (taps > 0) {
+        const int side_base = scratch[peak - 1] < scratch[peak + 1] ? peak - 1 : peak;
+        T lowest = scratch[peak];
+        for (int step = 1; step < upsampling; step++) {
+            const int step_phase = side_base < peak ? upsampling - step : step;
+            const T value = interpolate(&scratch[side_base - half_taps + 1], step_phase);
+            if (value < lowest) {
+                lowest = value;
+                base = side_base;
+                phase = step_phase;
+            }
+        }
+    }
+
+    if (phase == 0) {
+        std::memcpy(waveform, &scratch[base - length / 2], length * sizeof(T));
+        return true;
+    }
+    // resampled cut, output sample i at base - length / 2 + i + phase / upsampling
+    const T *src = &scratch[base - length / 2 - half_taps + 1];
+    const T *kernel = &kernels[phase * taps];
+    int i = 0;
+    for (; i + V::width <= length; i += V::width) {
+        V acc = V::zero();
+        for (int k = 0; k < taps; k++) acc = fmadd(V::broadcast(kernel[k]), V::loadu(src + i + k), acc);
+        acc.storeu(waveform + i);
+    }
+    for (; i < length; i++) waveform[i] = interpolate(src + i, phase);
+    return true;
+}
+
+template class WaveformAligner<float>;
+template class WaveformAligner<double>;
@@ -0,0 +1,57 @@
+#ifndef WAVEFORM_ALIGNER_H
+#define WAVEFORM_ALIGNER_H
+
+#include <string>
+#include <vector>
+#include "../../lib/aligned_allocator.h"
+#include "../pipeline/history_buffer.h"
+#include "spike_event.h"
+
+enum class Interpolation { none, cubic, sinc };
+Interpolation parseInterpolation(const std::string &name);
+
+// Cuts the classifier input of a spike event out of the filtered history,
+// centred on the negative peak instead of the threshold crossing. The peak
+// is the minimum of the `window` samples from the crossing on: the window is
+// copied into a buffer padded with +inf to whole vectors, a lane-wise running
+// minimum and one compare per vector find its first minimum.
+//
+// With interpolation, the peak is refined to 1/upsampling of a sample by
+// evaluating the interpolated signal at the upsampling - 1 phases between it
+// and its lower neighbour, and the cut is resampled at that phase, one tap
+// at a time over whole vectors of output samples. Both use the same table of
+// kernels per phase: Keys' cubic convolution (a = -0.5, 4 taps) or a Lanczos
+// windowed sinc (a = 4, 8 taps), normalised to unit DC gain. Phase 0 is the
+// plain cut. A window of one sample without interpolation cuts at the
+// crossing.
+template <typename T>
+class WaveformAligner {
+public:
+    static constexpr int upsampling = 8;
+
+    // length: samples per waveform, window: samples searched from the crossing on
+    WaveformAligner(int length, int window, Interpolation interpolation);
+
+    // samples after the crossing that have to be written before the event can be cut
+    [[nodiscard]] int getLookahead() const { return lookahead; }
+
+    // writes length samples to waveform, false if the range is not (or no longer) in the history
+    bool extract(const HistoryBuffer<T> &history, const SpikeEvent &event, long n_written, T *waveform);
+
+private:
+    int length;
+    int window;
+    int taps;           // 0 without interpolation
+    int half_taps;      // samples the kernels reach beyond the cut on either side
+    int lookahead;
+    aligned_vector<T> search;   // the window, padded with +inf
+    aligned_vector<T> scratch;  // the window and the cut around it, with the kernel margins
+    std::vector<T> kernels;     // [phase][tap]
+
+    // index of the first minimum of the window
+    int argmin(const T *samples);
+    // interpolated value between samples[half_taps - 1] and samples[half_taps] at the given phase
+    T interpolate(const T *samples, int phase) const;
+};
+
+#endif //WAVEFORM_ALIGNER_H
@@ -0,0 +1,74 @@
+// Generated by make_filter_design_reference.py with scipy 1.17.1, do not edit.
+#ifndef FILTER_DESIGN_REFERENCE_H
+#define FILTER_DESIGN_REFERENCE_H
+
+#include <vector>
+#include "../filter/filter_design.h"
+
+constexpr double reference_sampling_rate = 30000.0;
+
+struct IirReference {
+    IirFamily family;
+    int order;
+    BandType band;
+    double f1, f2;
+    double ripple_db, attenuation_db;
+    SosCascade sos;
+};
+
+inline const std::vector<IirReference> iir_references = {
+    {IirFamily::butterworth, 4, BandType::bandpass, 1000.0, 3000.0, 1.0, 40.0,
+     {{0.00117527954957051, 0.0023505590991410199, 0.00117527954957051, -1.4338896308142113, 0.61067510835597449}, {1, 2, 1, -1.6743526010997993, 0.74298981310803514}, {1, -2, 1, -1.4704497034513402, 0.79546219636038773}, {1, -2, 1, -1.8740466661032744, 0.91849207919608677}}},
+    {IirFamily::butterworth, 2, BandType::lowpass, 3000.0, 0.0, 1.0, 40.0,
+     {{0.067455273889071896, 0.13491054777814379, 0.067455273889071896, -1.1429805025399011, 0.41280159809618877}}},
+    {IirFamily::butterworth, 3, BandType::highpass, 300.0, 0.0, 1.0, 40.0,
+     {{0.93909165231195812, -0.93909165231195812, 0, -0.93906250581749229, 0}, {1, -2, 1, -1.9352943868599919, 0.93912079880642396}}},
+    {IirFamily::butterworth, 2, BandType::bandstop, 45.0, 55.0, 1.0, 40.0,
+     {{0.99852013510157378, -1.9969318661583535, 0.99852013510157422, -1.9982899778454171, 0.99841505415567366}, {1, -1.9998914352941084, 1.0000000000000004, -1.9985311337246061, 0.998625227108209}}},
+    {IirFamily::chebyshev1, 3, BandType::bandpass, 300.0, 5000.0, 1.0, 40.0,
+     {{0.038608405058557414, 0.077216810117114829, 0.038608405058557414, -1.5247116658523436, 0.58106272192671304}, {1, 0, -1, -0.84872461765416063, 0.67714642309928275}, {1, -2, 1, -1.9681825675011047, 0.97213764938888425}}},
+    {IirFamily::chebyshev1, 5, BandType::highpass, 500.0, 0.0, 0.5, 40.0,
+     {{0.80506862936763857, -0.80506862936763857, 0, -0.74726637865400103, 0}, {1, -2, 1, -1.8580387369151559, 0.87957048091206547}, {1, -2, 1, -1.9671919187017781, 0.97765241243575096}}},
+    {IirFamily::chebyshev2, 4, BandType::bandstop, 900.0, 1100.0, 1.0, 40.0,
+     {{0.908817011076264, -1.7751734515009108, 0.90881701107626367, -1.8809233412407409, 0.92973286299001434}, {1, -1.9599179388784005, 1, -1.9035973531586425, 0.9394888093395628}, {1, -1.9479517841967542, 1, -1.9058371112266803, 0.96749122257974873}, {1, -1.9640317868909707, 0.99999999999999989, -1.9478646892644296, 0.97736339138092643}}},
+    {IirFamily::chebyshev2, 6, BandType::lowpass, 6000.0, 0.0, 1.0, 60.0,
+     {{0.0062998789890072408, 0.0097619943803096375, 0.0062998789890072399, -0.79483543242474397, 0.1747440708550006}, {1, 0.054217374634228557, 1, -0.98274619435605282, 0.37547853238106155}, {1, -0.55466507732917347, 0.99999999999999978, -1.2960112709142195, 0.74099578403852551}}},
+};
+
+struct FirReference {
+    int num_taps;
+    BandType band;
+    double f1, f2;
+    FirWindow window;
+    std::vector<double> taps;
+};
+
+inline const std::vector<FirReference> fir_references = {
+    {31, BandType::bandpass, 1000.0, 3000.0, FirWindow::hamming,
+     {4.9238026796334194e-19, 0.00092101342452457254, 0.0018902387041411625, 0.0019153046223805467, -0.0012361422975326161, -0.01011936801972352, -0.025640959121105245, -0.045093252975344639, -0.061609893438785916, -0.065945061003818639, -0.05027040887217489, -0.012411736466308608, 0.041632843947643522, 0.09850560489847171, 0.14174654128393299, 0.15788820026345457, 0.14174654128393299, 0.09850560489847171, 0.041632843947643522, -0.012411736466308609, -0.050270408872174904, -0.065945061003818639, -0.061609893438785937, -0.045093252975344653, -0.025640959121105245, -0.010119368019723532, -0.001236142297532617, 0.0019153046223805467, 0.0018902387041411632, 0.00092101342452457254, 4.9238026796334194e-19}},
+    {15, BandType::lowpass, 3000.0, 0.0, FirWindow::hann,
+     {-0, -0.0016116510792971775, 1.5319670906982789e-18, 0.018979258583335053, 0.064383298086176877, 0.12825010797321151, 0.18562032743277729, 0.20875731800759301, 0.18562032743277729, 0.12825010797321151, 0.064383298086176877, 0.018979258583335053, 1.5319670906982789e-18, -0.0016116510792971775, -0}},
+    {21, BandType::highpass, 300.0, 0.0, FirWindow::blackman,
+     {2.5965057017183699e-19, -0.00017421852041002553, -0.00077081540999084986, -0.0019629755845114762, -0.0039209654493478404, -0.0066886986411854379, -0.010088749995134535, -0.013701955144991852, -0.01693993953228427, -0.019192368421176734, 0.98000050814896411, -0.019192368421176734, -0.01693993953228427, -0.013701955144991852, -0.010088749995134535, -0.0066886986411854379, -0.0039209654493478404, -0.0019629755845114762, -0.00077081540999084986, -0.00017421852041002553, 2.5965057017183699e-19}},
+    {33, BandType::bandstop, 900.0, 1100.0, FirWindow::boxcar,
+     {0.012338042429408664, 0.012642504678162862, 0.012392644720073799, 0.011597159790519064, 0.010289079948512567, 0.0085243819101713855, 0.0063795630296765273, 0.0039482819104172178, 0.0013372150678763336, -0.001338684723958046, -0.00396131497916499, -0.0064147034463370566, -0.0085902024700226492, -0.010391362235288297, -0.011738261621522368, -0.012571099813633252, 0.9511135116102164, -0.012571099813633252, -0.011738261621522368, -0.010391362235288297, -0.0085902024700226492, -0.0064147034463370566, -0.00396131497916499, -0.001338684723958046, 0.0013372150678763336, 0.0039482819104172178, 0.0063795630296765273, 0.0085243819101713855, 0.010289079948512567, 0.011597159790519064, 0.012392644720073799, 0.012642504678162862, 0.012338042429408664}},
+};
+
+struct NotchReference {
+    double frequency;
+    int harmonics;
+    double q;
+    double sampling_rate;
+    SosCascade sos;
+};
+
+inline const std::vector<NotchReference> notch_references = {
+    {50.0, 3, 30.0, 30000.0,
+     {{0.99982549752945538, -1.9995413529260975, 0.99982549752945538, -1.9995413529260975, 0.99965099505891075}, {0.99965105593988368, -1.9988636318878559, 0.99965105593988368, -1.9988636318878559, 0.99930211187976736}, {0.99947667518880789, -1.9979669875674859, 0.99947667518880789, -1.9979669875674859, 0.99895335037761579}}},
+    {60.0, 1, 10.0, 30000.0,
+     {{0.99937207592298405, -1.9985863394100911, 0.99937207592298405, -1.9985863394100911, 0.9987441518459681}}},
+    {60.0, 10, 35.0, 500.0,
+     {{0.9893431993199342, -1.4424003081139209, 0.9893431993199342, -1.4424003081139209, 0.97868639863986839}, {0.9789087428828398, -0.12293237707480141, 0.9789087428828398, -0.12293237707480141, 0.9578174857656796}, {0.96868739687443017, 1.2349291706699435, 0.96868739687443017, 1.2349291706699435, 0.93737479374886035}, {0.95867039780562446, 1.9022219907559175, 0.95867039780562446, 1.9022219907559175, 0.91734079561124893}}},
+};
+
+#endif //FILTER_DESIGN_REFERENCE_H
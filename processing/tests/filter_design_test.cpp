@@ -0,0 +1,61 @@
+// Compares designIir, designFir and designNotches against the scipy.signal
+// designs stored in filter_design_reference.h (butter/cheby1/cheby2 with
+// output='sos', firwin and iirnotch). Returns nonzero on a mismatch.
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "../filter/filter_design.h"
+#include "filter_design_reference.h"
+
+static constexpr double tolerance = 1e-9;
+
+static int failures = 0;
+
+static void expectClose(const std::string &name, const std::vector<double> &actual, const std::vector<double> &expected) {
+    if (actual.size() != expected.size()) {
+        std::cerr << name << ": " << actual.size() << " coefficients, expected " << expected.size() << std::endl;
+        failures++;
+        return;
+    }
+    for (size_t i = 0; i < actual.size(); i++) {
+        // relative to the coefficient, absolute near zero
+        if (std::abs(actual[i] - expected[i]) > tolerance * std::max(1.0, std::abs(expected[i]))) {
+            std::cerr.precision(17);
+            std::cerr << name << ": coefficient " << i << " is " << actual[i] << ", expected " << expected[i] << std::endl;
+            failures++;
+            return;
+        }
+    }
+}
+
+static std::vector<double> flatten(const SosCascade &sos) {
+    std::vector<double> values;
+    for (const auto &s : sos) values.insert(values.end(), {s.b0, s.b1, s.b2, s.a1, s.a2});
+    return values;
+}
+
+int main() {
+    for (const auto &ref : iir_references) {
+        const std::string name = "designIir(family " + std::to_string(static_cast<int>(ref.family)) + ", order " +
+                                 std::to_string(ref.order) + ", band " + std::to_string(static_cast<int>(ref.band)) + ")";
+        expectClose(name, flatten(designIir(ref.family, ref.order, ref.band, ref.f1, ref.f2, reference_sampling_rate,
+                                            ref.ripple_db, ref.attenuation_db)), flatten(ref.sos));
+    }
+    for (const auto &ref : fir_references) {
+        const std::string name = "designFir(" + std::to_string(ref.num_taps) + " taps, band " +
+                                 std::to_string(static_cast<int>(ref.band)) + ", window " +
+                                 std::to_string(static_cast<int>(ref.window)) + ")";
+        expectClose(name, designFir(ref.num_taps, ref.band, ref.f1, ref.f2, reference_sampling_rate, ref.window), ref.taps);
+    }
+    for (const auto &ref : notch_references) {
+        const std::string name = "designNotches(" + std::to_string(ref.frequency) + " Hz, " +
+                                 std::to_string(ref.harmonics) + " harmonics, fs " + std::to_string(ref.sampling_rate) + ")";
+        expectClose(name, flatten(designNotches(ref.frequency, ref.harmonics, ref.q, ref.sampling_rate)), flatten(ref.sos));
+    }
+
+    const size_t n_cases = iir_references.size() + fir_references.size() + notch_references.size();
+    std::cout << n_cases - failures << "/" << n_cases << " filter designs match scipy" << std::endl;
+    return failures == 0 ? 0 : 1;
+}
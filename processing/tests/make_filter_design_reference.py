@@ -0,0 +1,105 @@
+"""Writes filter_design_reference.h: scipy.signal designs that
+filter_design_test.cpp compares designIir / designFir / designNotches against.
+
+usage: python make_filter_design_reference.py > filter_design_reference.h
+"""
+import numpy as np
+import scipy
+from scipy import signal
+
+FS = 30000.0
+
+# family, order, band, f1, f2, ripple_db, attenuation_db
+IIR_CASES = [
+    ('butterworth', 4, 'bandpass', 1000.0, 3000.0, 1.0, 40.0),
+    ('butterworth', 2, 'lowpass', 3000.0, 0.0, 1.0, 40.0),
+    ('butterworth', 3, 'highpass', 300.0, 0.0, 1.0, 40.0),
+    ('butterworth', 2, 'bandstop', 45.0, 55.0, 1.0, 40.0),
+    ('chebyshev1', 3, 'bandpass', 300.0, 5000.0, 1.0, 40.0),
+    ('chebyshev1', 5, 'highpass', 500.0, 0.0, 0.5, 40.0),
+    ('chebyshev2', 4, 'bandstop', 900.0, 1100.0, 1.0, 40.0),
+    ('chebyshev2', 6, 'lowpass', 6000.0, 0.0, 1.0, 60.0),
+]
+
+# num_taps, band, f1, f2, window
+FIR_CASES = [
+    (31, 'bandpass', 1000.0, 3000.0, 'hamming'),
+    (15, 'lowpass', 3000.0, 0.0, 'hann'),
+    (21, 'highpass', 300.0, 0.0, 'blackman'),
+    (33, 'bandstop', 900.0, 1100.0, 'boxcar'),
+]
+
+# frequency, harmonics, q, sampling rate (the last one has harmonics above Nyquist)
+NOTCH_CASES = [
+    (50.0, 3, 30.0, FS),
+    (60.0, 1, 10.0, FS),
+    (60.0, 10, 35.0, 500.0),
+]
+
+
+def iir(family, order, band, f1, f2, ripple, attenuation):
+    edges = [f1, f2] if band in ('bandpass', 'bandstop') else f1
+    btype = {'lowpass': 'low', 'highpass': 'high', 'bandpass': 'bandpass', 'bandstop': 'bandstop'}[band]
+    if family == 'butterworth':
+        return signal.butter(order, edges, btype, fs=FS, output='sos')
+    if family == 'chebyshev1':
+        return signal.cheby1(order, ripple, edges, btype, fs=FS, output='sos')
+    return signal.cheby2(order, attenuation, edges, btype, fs=FS, output='sos')
+
+
+def fir(num_taps, band, f1, f2, window):
+    edges = [f1, f2] if band in ('bandpass', 'bandstop') else f1
+    pass_zero = band in ('lowpass', 'bandstop')
+    return signal.firwin(num_taps, edges, window=window, pass_zero=pass_zero, fs=FS)
+
+
+def notches(frequency, harmonics, q, fs):
+    sections = []
+    for h in range(1, harmonics + 1):
+        if h * frequency >= fs / 2:
+            break
+        b, a = signal.iirnotch(h * frequency, q, fs)
+        sections.append(np.concatenate([b, a]))
+    return np.array(sections)
+
+
+def sos_rows(sos):
+    # b0, b1, b2, a1, a2 with a0 = 1
+    return ", ".join(f"{{{s[0]:.17g}, {s[1]:.17g}, {s[2]:.17g}, {s[4]:.17g}, {s[5]:.17g}}}" for s in sos)
+
+
+def values(v):
+    return ", ".join(f"{x:.17g}" for x in v)
+
+
+if __name__ == "__main__":
+    print(f"// Generated by make_filter_design_reference.py with scipy {scipy.__version__}, do not edit.")
+    print("#ifndef FILTER_DESIGN_REFERENCE_H\n#define FILTER_DESIGN_REFERENCE_H\n")
+    print('#include <vector>\n#include "../filter/filter_design.h"\n')
+    print(f"constexpr double reference_sampling_rate = {FS};\n")
+
+    print("struct IirReference {\n    IirFamily family;\n    int order;\n    BandType band;\n    double f1, f2;\n"
+          "    double ripple_db, attenuation_db;\n    SosCascade sos;\n};\n")
+    print("inline const std::vector<IirReference> iir_references = {")
+    for case in IIR_CASES:
+        family, order, band, f1, f2, ripple, attenuation = case
+        print(f"    {{IirFamily::{family}, {order}, BandType::{band}, {f1}, {f2}, {ripple}, {attenuation},\n"
+              f"     {{{sos_rows(iir(*case))}}}}},")
+    print("};\n")
+
+    print("struct FirReference {\n    int num_taps;\n    BandType band;\n    double f1, f2;\n    FirWindow window;\n"
+          "    std::vector<double> taps;\n};\n")
+    print("inline const std::vector<FirReference> fir_references = {")
+    for case in FIR_CASES:
+        num_taps, band, f1, f2, window = case
+        print(f"    {{{num_taps}, BandType::{band}, {f1}, {f2}, FirWindow::{window},\n     {{{values(fir(*case))}}}}},")
+    print("};\n")
+
+    print("struct NotchReference {\n    double frequency;\n    int harmonics;\n    double q;\n    double sampling_rate;\n"
+          "    SosCascade sos;\n};\n")
+    print("inline const std::vector<NotchReference> notch_references = {")
+    for case in NOTCH_CASES:
+        frequency, harmonics, q, fs = case
+        print(f"    {{{frequency}, {harmonics}, {q}, {fs},\n     {{{sos_rows(notches(*case))}}}}},")
+    print("};\n")
+    print("#endif //FILTER_DESIGN_REFERENCE_H")
@@ -0,0 +1,170 @@
+"""Compares the spike detectors (detector.type) on the same replay data.
+
+Every detector runs the processing binary in replay mode over sim_data_path
+at each channel count. Reported per run:
+  - the real-time factor of the whole replay
+  - the median per-chunk p50 of the filter stage (filtering plus the
+    detector's crossing masks) and of the detect stage (refractory period
+    and events)
+  - the detected spikes and, against a reference, precision / recall / F1
+
+The reference is a ground truth file of "sample,channel" lines in pipeline
+sample indices (all replay passes) if given, otherwise the events of the
+amplitude detector. With --target the cheapest detector reaching that F1 is
+picked for each channel count.
+
+usage: python run_detector_benchmark.py [config] [--channels 64,256,1024]
+       [--types amplitude,neo,matched] [--threshold neo=20] [--ground-truth file]
+       [--tolerance 15] [--target 0.9] [--binary path]
+"""
+import argparse
+import bisect
+import collections
+import json
+import os
+import re
+import statistics
+import subprocess
+import tempfile
+import yaml
+
+
+def load_events(path, n_channel=None):
+    events = collections.defaultdict(list)
+    with open(path, 'r') as file:
+        for line in file:
+            line = line.strip()
+            if not line:
+                continue
+            sample, channel = (int(float(v)) for v in re.split(r'[,;]', line)[:2])
+            if n_channel is None or channel < n_channel:
+                events[channel].append(sample)
+    for samples in events.values():
+        samples.sort()
+    return events
+
+
+def match_events(detected, reference, tolerance):
+    """greedy matching per channel, each reference spike matches at most one detection"""
+    hits = 0
+    for channel, ref in reference.items():
+        used = [False] * len(ref)
+        for sample in detected.get(channel, []):
+            i = bisect.bisect_left(ref, sample - tolerance)
+            while i < len(ref) and ref[i] <= sample + tolerance:
+                if not used[i]:
+                    used[i] = True
+                    hits += 1
+                    break
+                i += 1
+    n_detected = sum(len(v) for v in detected.values())
+    n_reference = sum(len(v) for v in reference.values())
+    precision = hits / n_detected if n_detected else 0.0
+    recall = hits / n_reference if n_reference else 0.0
+    f1 = 2 * precision * recall / (precision + recall) if precision + recall > 0 else 0.0
+    return precision, recall, f1
+
+
+def stage_p50(metrics_path, stage, warmup):
+    values = []
+    with open(metrics_path, 'r') as file:
+        for line in file:
+            report = json.loads(line)
+            if report['time'] > warmup and report['stages'][stage]['count'] > 0:
+                values.append(report['stages'][stage]['p50_us'])
+    return statistics.median(values) if values else float('nan')
+
+
+def run_detector(binary, base_config, workdir, n_channel, detector_type, threshold):
+    config = yaml.safe_load(yaml.safe_dump(base_config))
+    name = f"{detector_type}_{n_channel}"
+    events_path = os.path.join(workdir, name + "_events.csv")
+    metrics_path = os.path.join(workdir, name + "_metrics.json")
+    config['n_channel'] = n_channel
+    config['do_plot'] = False
+    config.setdefault('pipeline', {})['source'] = 'replay'
+    config.setdefault('detector', {})['type'] = detector_type
+    config['detector']['events_path'] = events_path
+    if threshold is not None:
+        config['detector']['threshold'] = threshold
+    config.setdefault('metrics', {}).update({'path': metrics_path, 'outlet': False, 'interval': 1.0})
+    config_path = os.path.join(workdir, name + ".yaml")
+    with open(config_path, 'w') as file:
+        yaml.dump(config, file)
+
+    print(f"Running {detector_type} detector with {n_channel} channels...")
+    result = subprocess.run([binary, config_path], stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+    output = result.stdout.decode('utf-8')
+    if result.returncode != 0:
+        print(result.stderr.decode('utf-8'))
+        raise RuntimeError(f"{binary} failed for {name}")
+    match = re.search(r'\(([\d.e+]+)x real time\)', output)
+    warmup = config['detector'].get('warmup', 5.0)
+    return {
+        'type': detector_type,
+        'channels': n_channel,
+        'realtime': float(match.group(1)) if match else float('nan'),
+        'filter_us': stage_p50(metrics_path, 'filter', warmup),
+        'detect_us': stage_p50(metrics_path, 'detect', warmup),
+        'events': load_events(events_path),
+    }
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Benchmark the spike detectors on the same replay data")
+    parser.add_argument('config', nargs='?', default='config/default.yaml')
+    parser.add_argument('--binary', default='./processing/cmake-build-debug/processing')
+    parser.add_argument('--channels', default='64,256,1024')
+    parser.add_argument('--types', default='amplitude,neo,matched')
+    parser.add_argument('--threshold', action='append', default=[], help="per detector, e.g. neo=20")
+    parser.add_argument('--ground-truth', default=None)
+    parser.add_argument('--tolerance', type=int, default=15, help="samples between a detection and its reference spike")
+    parser.add_argument('--target', type=float, default=None, help="F1 the chosen detector has to reach")
+    args = parser.parse_args()
+
+    with open(args.config, 'r') as file:
+        base_config = yaml.safe_load(file)
+    if not base_config.get('sim_data_path'):
+        raise SystemExit("The config needs a sim_data_path to replay")
+    channel_counts = [int(n) for n in args.channels.split(',')]
+    types = args.types.split(',')
+    thresholds = {t: float(v) for t, v in (entry.split('=') for entry in args.threshold)}
+    if args.ground_truth is None and 'amplitude' not in types:
+        types.insert(0, 'amplitude')
+
+    results = []
+    with tempfile.TemporaryDirectory() as workdir:
+        for n_channel in channel_counts:
+            runs = [run_detector(args.binary, base_config, workdir, n_channel, t, thresholds.get(t)) for t in types]
+            if args.ground_truth:
+                reference, reference_name = load_events(args.ground_truth, n_channel), "ground truth"
+            else:
+                reference, reference_name = next(r['events'] for r in runs if r['type'] == 'amplitude'), "amplitude"
+            for run in runs:
+                run['precision'], run['recall'], run['f1'] = match_events(run['events'], reference, args.tolerance)
+                run['spikes'] = sum(len(v) for v in run['events'].values())
+                del run['events']
+            results.extend(runs)
+
+    print(f"\nReference: {reference_name}, tolerance {args.tolerance} samples")
+    print(f"{'detector':<10} {'channels':>8} {'realtime':>9} {'filter_us':>10} {'detect_us':>10} {'spikes':>8} "
+          f"{'precision':>9} {'recall':>7} {'f1':>6}")
+    for r in results:
+        print(f"{r['type']:<10} {r['channels']:>8} {r['realtime']:>8.1f}x {r['filter_us']:>10.2f} {r['detect_us']:>10.2f} "
+              f"{r['spikes']:>8} {r['precision']:>9.3f} {r['recall']:>7.3f} {r['f1']:>6.3f}")
+
+    if args.target is not None:
+        print(f"\nCheapest detector with F1 >= {args.target}:")
+        for n_channel in channel_counts:
+            candidates = [r for r in results if r['channels'] == n_channel and r['f1'] >= args.target]
+            if candidates:
+                best = min(candidates, key=lambda r: r['filter_us'] + r['detect_us'])
+                print(f"  {n_channel} channels: {best['type']} ({best['filter_us'] + best['detect_us']:.2f} us per chunk)")
+            else:
+                print(f"  {n_channel} channels: none")
+
+    with open("detector_benchmark_results.txt", "a") as file:
+        for r in results:
+            file.write(f"{r['type']} {r['channels']} channels: {r['realtime']:.1f}x real time, "
+                       f"filter {r['filter_us']:.2f} us, detect {r['detect_us']:.2f} us, F1 {r['f1']:.3f}\n")
+    print("Results appended to detector_benchmark_results.txt")
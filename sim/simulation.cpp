@@ -86,7 +86,9 @@ void Simulation::setupXdfFile() {
 }
 
 lsl::stream_outlet Simulation::createLSLStream() const {
-    lsl::stream_info info(cfg.stream_name, "EEG", cfg.n_channel, cfg.sampling_rate, lsl::cf_double64, "myuid34234");
+    // stream in the sample type the processing pipeline runs on
+    const lsl::channel_format_t format = (cfg.pipeline.sample_type == "float") ? lsl::cf_float32 : lsl::cf_double64;
+    lsl::stream_info info(cfg.stream_name, "EEG", cfg.n_channel, cfg.sampling_rate, format, "myuid34234");
     lsl::stream_outlet outlet(info);
     return outlet;
 }